@@ -3,440 +3,4793 @@
 // Last Updated: 02/20/2025
 
 #include <stdio.h>
+#include <stdarg.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <stdatomic.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Webs with at least this many relations are rebuilt across threads when
+// the program is compiled with OpenMP (-fopenmp).
+#ifndef PARALLEL_MIN_EDGES
+#define PARALLEL_MIN_EDGES (1 << 16)
+#endif
+
+// Fractional trophic levels are solved until no level changes by more than
+// this between sweeps, giving up after the given number of sweeps.
+#define TROPHIC_TOLERANCE 1e-9
+#define MAX_TROPHIC_SWEEPS 10000
 
 typedef struct Org_struct {
-    char name[20];
-    int* prey; //dynamic array of indices
-    int numPrey;
+    int nameOff;   // offset of the organism's interned name in the name pool
+    int preyStart; // first slot of this organism's prey run in the edge arena
+    int numPrey;   // number of prey indices stored in the run
+    int preyCap;   // slots reserved for the run (slack for new relations)
+    bool extinct;  // tombstone: the slot is reclaimed by the next compactWeb()
 } Org;
 
-void addOrgToWeb(Org** pWeb, int* pNumOrgs, char* newOrgName) {
-
-    // Check if the food web is currently empty.
-    if (*pWeb == NULL) {
-        // Allocate memory for one organism's name.
-        *pWeb = (Org*)malloc(sizeof(Org));
-        // Copy the new organism's name.
-        strcpy((*pWeb)[0].name, newOrgName);
-        // Initialize the prey pointer to NULL and number of preys to 0.
-        (*pWeb)[0].prey = NULL;
-        (*pWeb)[0].numPrey = 0;
-        // Update the number of organisms.
-        *pNumOrgs = 1;
-    } else {
-        // Calculate the new size (one more than current).
-        int oldCount = *pNumOrgs;
-        int newCount = oldCount + 1;
+typedef struct OrgLinks_struct {
+    int predStart; // first slot of this organism's predator run in the edge arena
+    int numPred;   // number of predators stored in the run (in-degree)
+    int predCap;   // slots reserved for the run
+    int numProducerPrey; // number of prey that are producers (drives the vore type)
+    int height;    // food web height while the web's heightsValid is set, -1 = fed by a cycle
+} OrgLinks;
+
+typedef struct Buckets_struct {
+    int* heads;    // heads[d] = first live organism with degree d, -1 if none
+    int capHeads;  // number of degree buckets allocated
+    int* prev;     // previous organism in the same bucket, -1 if first (parallel to orgs)
+    int* next;     // next organism in the same bucket, -1 if last (parallel to orgs)
+    int maxDeg;    // largest degree among live organisms
+} Buckets;
+
+typedef struct NameEntry_struct {
+    int nameOff;   // offset of the interned name in the name pool, -1 = empty slot
+    uint32_t hash; // hash of the name
+    int orgInd;    // organism addressed by this name (lowest index), -1 if none
+    int refs;      // number of organisms sharing this name
+} NameEntry;
+
+// Strongly connected components of the web and the condensed DAG between
+// them, numbered prey-first: every component's prey components come before it.
+typedef struct Condensation_struct {
+    int numComps;     // number of components
+    int* compOf;      // component of each organism (parallel to orgs)
+    int* memberStart; // members of component c are members[memberStart[c] .. memberStart[c + 1])
+    int* members;     // organisms grouped by component, in index order
+    int* dagStart;    // prey components of c are dagPrey[dagStart[c] .. dagStart[c + 1])
+    int* dagPrey;     // condensed relations, one per pair of components
+    int* numPred;     // number of predator components (0 = apex component)
+    int* height;      // food web height of each component in the condensed DAG
+    int capOrgs;      // organisms the per-organism and per-component arrays can hold
+    int capDag;       // condensed relations dagPrey can hold
+} Condensation;
+
+// Index over the condensation for "does X ultimately eat Y" queries, valid
+// while version matches the web's. Webs of up to REACH_CLOSURE_COMPS
+// components keep the whole transitive closure as one bit row per component.
+// Larger ones label component c once per traversal with its finishing rank,
+// the lowest rank among what it reaches and the highest among what reaches
+// it, at rank[REACH_LABELS * c + k] and so on, and searches use the web's
+// condensation.
+#ifndef REACH_CLOSURE_COMPS
+#define REACH_CLOSURE_COMPS (1 << 14)
+#endif
+#define REACH_LABELS 2
+typedef struct ReachIndex_struct {
+    unsigned int version; // web version the index was built for, 0 = never built
+    uint64_t* closure; // bit d of row c is set if component c reaches d, NULL when labeled
+    int rowWords;   // 64-bit words per closure row
+    size_t capClosure; // words allocated for the closure
+    int* rank;      // finishing number of each component in each traversal
+    int* low;       // lowest finishing number among what each component reaches
+    int* high;      // highest finishing number among what reaches each component
+    int* stamps;    // last single query that visited each component
+    int* stack;     // components still to be expanded by a single query
+    int lastQuery;  // number of the last single query
+    int capComps;   // number of components the arrays can hold
+} ReachIndex;
+
+// Food chains (paths from a producer to an apex predator) counted over the
+// condensation by countFoodChains(), per component and in total. Counts are
+// kept exactly modulo CHAIN_MOD and as long double estimates of their size;
+// an estimate of infinity marks a count a feeding cycle makes unbounded.
+#define CHAIN_MOD ((1ull << 61) - 1)
+typedef struct ChainCounts_struct {
+    uint64_t* upMod;      // chains from a producer up to each component
+    long double* upEst;
+    uint64_t* downMod;    // chains from each component up to an apex predator
+    long double* downEst;
+    uint64_t totalMod;    // all chains in the web
+    long double totalEst;
+    int capComps;         // number of components the arrays can hold
+} ChainCounts;
+
+typedef struct Web_struct {
+    Org* orgs;       // dynamic array of organisms
+    int numOrgs;     // number of organism slots in use, tombstones included
+    int numExtinct;  // tombstoned organisms waiting for compactWeb()
+    int capOrgs;     // number of organisms the array can hold before growing
+    int* liveTree;   // Fenwick tree counting live organisms by slot (1-based), see selectLiveOrg()
+    int capLiveTree; // number of entries allocated for the tree
+    bool liveTreeValid; // false once slots are renumbered; the next selectLiveOrg() rebuilds it
+    OrgLinks* links; // reverse adjacency and derived characteristics, parallel to orgs
+    Buckets byNumPred; // organisms grouped by in-degree (apex predators, tastiest food)
+    Buckets byNumPrey; // organisms grouped by out-degree (producers, flexible eaters)
+    bool heightsValid; // false once a feeding cycle (or failed allocation) needs a full recompute
+    Condensation cond; // feeding-cycle analysis, filled in by condenseWeb()
+    double* levels;    // fractional trophic levels, filled in by computeTrophicLevels()
+    double* nextLevels; // levels of the next sweep while solving them
+    int capLevels;     // number of organisms both level arrays can hold
+    ReachIndex reach;  // reachability labels, rebuilt by buildReachIndex() when stale
+    ChainCounts chains; // food chain counts, filled in by countFoodChains()
+    unsigned int version; // bumped by every change, so derived indexes can tell they are stale
+    int* work;       // scratch worklist for incremental updates
+    int capWork;     // number of ints allocated for the worklist
+    int* edges;      // edge arena (CSR): each organism's prey run and predator run
+    int endEdges;    // first slot after the last run handed out
+    int capEdges;    // number of slots allocated for the arena
+    int numEdges;    // number of predator/prey relations (each fills two slots)
+    int freedEdges;  // slots left behind by relocated or extinct runs
+    int* spare;      // previous arena, reused as the destination of the next rebuild
+    int capSpare;    // number of slots allocated for the spare arena
+    uint64_t* edgeKeys; // open-addressing hash set of (predator, prey) keys, 0 = empty
+    int capEdgeKeys;    // number of hash slots (always a power of two)
+    int numEdgeKeys;    // number of keys in the hash set
+    char* names;          // interned name pool: NUL-terminated names back to back
+    int lenNames;         // bytes used in the name pool
+    int capNames;         // bytes allocated for the name pool
+    NameEntry* nameIndex; // open-addressing hash index from name to organism
+    int capNameIndex;     // number of hash slots (always a power of two)
+    int numNames;         // number of distinct names interned
+    char* snapshot;       // mapped snapshot the arrays above point into, NULL if they are owned
+    size_t lenSnapshot;   // length of the mapping
+} Web;
+
+// A batch of names parsed from an import file, resolved together so that
+// their name index slots can be fetched from memory ahead of the lookups.
+#define IMPORT_BATCH 64
+typedef struct ImportBatch_struct {
+    int numNames;
+    const char* starts[IMPORT_BATCH]; // first character of each name in the file
+    int lens[IMPORT_BATCH];           // length of each name
+    uint32_t hashes[IMPORT_BATCH];    // nameHash() of each name, computed while parsing
+    bool firsts[IMPORT_BATCH];        // whether the name is the first one on its line
+} ImportBatch;
+
+// Parameters of a synthetic food web (-g <model> <species> <connectance>).
+typedef struct WebModel_struct {
+    char kind;          // 'c' = cascade model, 'n' = niche model, 0 = none requested
+    int numSpecies;     // number of organisms to generate
+    double connectance; // expected relations divided by species squared
+} WebModel;
+
+// Operations of each kind timed at every scale of a benchmark (-p).
+#define BENCHMARK_OPS 1000
+
+// One modification queued in a batch, using the menu's letters.
+typedef struct WebOp_struct {
+    char kind;   // 'o', 'r', 'R', 'x' or 'X'
+    int args[2]; // organism indices ('r', 'x') or offsets into the batch's name pool ('o', 'R', 'X')
+} WebOp;
+
+// Modifications applied together by applyBatch().
+typedef struct WebBatch_struct {
+    WebOp* ops;
+    int numOps;
+    int capOps;
+    char* names;  // names used by the operations, NUL-terminated back to back
+    int lenNames;
+    int capNames;
+} WebBatch;
+
+// Generalized Lotka-Volterra dynamics on the web. Organism i changes at
+// x_i * (r_i - x_i + e * a_i * (sum of its prey) - sum over its predators
+// of a_p * x_p): producers grow at r = 1 and consumers die at r = -0.1 without
+// food, everything crowds itself, and a predator's attack rate a is spread
+// evenly over its prey, of which it converts a fraction e into biomass. State
+// is kept one array per quantity, indexed like the organisms.
+#define LV_PRODUCER_GROWTH 1.0
+#define LV_CONSUMER_GROWTH (-0.1)
+#define LV_ATTACK 1.0
+#define LV_EFFICIENCY 0.5
+#define LV_EXTINCT 1e-9 // biomass below which an organism dies out
+typedef struct Dynamics_struct {
+    double* biomass; // current state
+    double* stage;   // state at the current Runge-Kutta stage
+    double* slope;   // rate of change at that stage
+    double* sum;     // weighted sum of the stage slopes so far
+    double* flux;    // a_p * x_p at that stage, per predator
+    double* growth;  // r_i
+    double* attack;  // a_i, per prey
+    int capOrgs;     // organisms every array can hold
+} Dynamics;
+
+// Characteristics of one web as displayAll() reports them, in counts, for
+// one row of a batch analysis (-a).
+typedef struct WebSummary_struct {
+    bool ok;           // false if the web could not be read
+    int numOrgs;
+    int numEdges;
+    int numSkipped;    // duplicate and self relations left out of the file
+    int numApex;       // apex predators
+    int numVores[4];   // producers, herbivores, omnivores and carnivores
+    int mostPrey;      // prey of the most flexible eaters
+    int numFlexible;   // most flexible eaters
+    int mostPred;      // predators of the tastiest food
+    int numTastiest;   // tastiest food
+    int height;        // food web height (of the condensation if there are cycles)
+    int numCycles;     // feeding cycles
+} WebSummary;
+
+// Header of a binary web snapshot. The sections follow at the recorded
+// offsets (8-byte aligned) and hold the arrays exactly as they sit in memory,
+// so a snapshot is only read back by a build with the same struct layout.
+#define SNAPSHOT_VERSION 1
+#define NUM_SNAPSHOT_SECTIONS 11
+typedef struct SnapshotHeader_struct {
+    char magic[8];         // "FOODWEB" and a NUL
+    uint32_t version;      // SNAPSHOT_VERSION
+    uint32_t byteOrder;    // 0x01020304 as written by the saving machine
+    uint32_t structSizes[3]; // sizeof(Org), sizeof(OrgLinks), sizeof(NameEntry)
+    int32_t numOrgs;
+    int32_t numEdges;
+    int32_t lenNames;
+    int32_t capNameIndex;
+    int32_t numNames;
+    int32_t capPredHeads;  // degree buckets saved for byNumPred and byNumPrey
+    int32_t capPreyHeads;
+    int32_t maxNumPred;
+    int32_t maxNumPrey;
+    int32_t heightsValid;
+    uint64_t offsets[NUM_SNAPSHOT_SECTIONS]; // orgs, links, edges, names, name index, then
+                                             // heads, prev, next for both bucket sets
+    uint64_t sizes[NUM_SNAPSHOT_SECTIONS];   // bytes in each section
+} SnapshotHeader;
+
+// What-if branches: persistent copies of a web that share structure. Each
+// branch is a radix trie over organism indices, BRANCH_BITS of the index per
+// level, whose leaves are organism records holding reference-counted prey and
+// predator blocks. Forking a branch shares its root; a change copies only the
+// trie nodes, records and blocks on its path that another branch still shares.
+#define BRANCH_BITS 5
+#define BRANCH_FANOUT (1 << BRANCH_BITS)
+
+typedef struct PBlock_struct {
+    int refs;    // organism records sharing the block
+    int num;     // indices stored
+    int cap;     // indices the block can hold
+    int items[]; // prey or predator indices
+} PBlock;
+
+typedef struct POrg_struct {
+    int refs;      // trie nodes sharing the record
+    int nameOff;   // offset of the organism's name in the branch set's name pool
+    bool extinct;  // tombstone: indices never move within a branch set
+    PBlock* prey;  // prey in the order they were added, NULL if none
+    PBlock* preds; // predators, NULL if none
+} POrg;
+
+typedef struct PNode_struct {
+    int refs;                   // parent nodes and branch roots sharing the node
+    void* kids[BRANCH_FANOUT];  // POrg* on the last level, PNode* above it, NULL past the last organism
+} PNode;
+
+typedef struct Branch_struct {
+    PNode* root;
+    int numLive;  // organisms not extinct in this branch
+    int numEdges; // predator/prey relations in this branch
+} Branch;
+
+typedef struct BranchSet_struct {
+    Branch* branches;
+    int numBranches;
+    int capBranches;
+    int numOrgs;      // organism slots in every branch, tombstones included
+    int depth;        // trie levels above the last one
+    char* names;      // copy of the frozen web's name pool
+    int lenNames;
+    long numNodes;    // trie nodes, records and blocks currently allocated,
+    long numRecords;  // counted once however many branches share them
+    long numBlocks;
+} BranchSet;
+
+// Publishing a branch to readers on other threads, RCU style. The writer
+// changes branch 0 of its set and publishes views of it. A view shares the
+// branch's root like a fork, so the writer's later changes copy what the view
+// still shares instead of editing it. Readers pin the current epoch in their
+// slot and then read whichever view is current, without locks. A replaced
+// view is retired with the epoch that replaced it and freed once no slot
+// pins an older epoch. Only the writer thread touches reference counts.
+#define MAX_SNAPSHOT_READERS 64
+typedef struct WebView_struct {
+    Branch branch;             // never changed once published
+    unsigned long retiredAt;   // epoch at which a newer view replaced it
+    struct WebView_struct* nextRetired;
+} WebView;
+
+typedef struct SnapshotPublisher_struct {
+    BranchSet set;             // the writer's branch is branch 0
+    _Atomic(WebView*) current; // view new readers get
+    atomic_ulong epoch;        // bumped whenever a view is replaced
+    atomic_ulong readers[MAX_SNAPSHOT_READERS]; // epoch pinned by each reader slot, 0 = not reading
+    WebView* retired;          // replaced views not freed yet, newest first
+    int numRetired;
+} SnapshotPublisher;
+
+void initBuckets(Buckets* buckets) {
+    buckets -> heads = NULL;
+    buckets -> capHeads = 0;
+    buckets -> prev = NULL;
+    buckets -> next = NULL;
+    buckets -> maxDeg = 0;
+}
+
+void freeBuckets(Buckets* buckets) {
+    free(buckets -> heads);
+    free(buckets -> prev);
+    free(buckets -> next);
+    initBuckets(buckets);
+}
+
+// Make sure there is a bucket for every degree up to maxDeg.
+bool reserveBuckets(Buckets* buckets, int maxDeg) {
+
+    // Nothing to do if there is already a bucket for this degree.
+    if (maxDeg < buckets -> capHeads) {
+        return true;
+    }
+
+    int newCap = (buckets -> capHeads > 0) ? buckets -> capHeads : 8;
+    while (newCap <= maxDeg) {
+        newCap *= 2;
+    }
+
+    int* newHeads = (int*)realloc(buckets -> heads, newCap * sizeof(int));
+    if (newHeads == NULL) {
+        return false; // Memory allocation failed.
+    }
+    for (int d = buckets -> capHeads; d < newCap; d++) {
+        newHeads[d] = -1;
+    }
+
+    buckets -> heads = newHeads;
+    buckets -> capHeads = newCap;
+    return true;
+}
+
+// Resize the per-organism links along with the organism array. A grown
+// array is stored as soon as it is allocated, since realloc may have moved
+// it; on failure both arrays still hold everything they held before.
+bool reserveBucketLinks(Buckets* buckets, size_t linkBytes) {
+    int* newPrev = (int*)realloc(buckets -> prev, linkBytes);
+    if (newPrev == NULL) {
+        return false; // Memory allocation failed.
+    }
+    buckets -> prev = newPrev;
+
+    int* newNext = (int*)realloc(buckets -> next, linkBytes);
+    if (newNext == NULL) {
+        return false; // Memory allocation failed.
+    }
+    buckets -> next = newNext;
+    return true;
+}
+
+// Put an organism at the front of the bucket for its degree.
+// The bucket must already exist (see reserveBuckets()).
+void linkBucket(Buckets* buckets, int orgInd, int deg) {
+    int head = buckets -> heads[deg];
+    buckets -> prev[orgInd] = -1;
+    buckets -> next[orgInd] = head;
+    if (head != -1) {
+        buckets -> prev[head] = orgInd;
+    }
+    buckets -> heads[deg] = orgInd;
+    if (deg > buckets -> maxDeg) {
+        buckets -> maxDeg = deg;
+    }
+}
+
+// Take an organism out of the bucket for its degree.
+void unlinkBucket(Buckets* buckets, int orgInd, int deg) {
+    int prev = buckets -> prev[orgInd];
+    int next = buckets -> next[orgInd];
+    if (prev != -1) {
+        buckets -> next[prev] = next;
+    } else {
+        buckets -> heads[deg] = next;
+    }
+    if (next != -1) {
+        buckets -> prev[next] = prev;
+    }
+
+    // The largest degree only drops when its bucket runs empty.
+    while (buckets -> maxDeg > 0 && buckets -> heads[buckets -> maxDeg] == -1) {
+        buckets -> maxDeg--;
+    }
+}
+
+// Move an organism from the bucket for oldDeg to the one for newDeg.
+void moveBucket(Buckets* buckets, int orgInd, int oldDeg, int newDeg) {
+    unlinkBucket(buckets, orgInd, oldDeg);
+    linkBucket(buckets, orgInd, newDeg);
+}
+
+void initCondensation(Condensation* cond) {
+    cond -> numComps = 0;
+    cond -> compOf = NULL;
+    cond -> memberStart = NULL;
+    cond -> members = NULL;
+    cond -> dagStart = NULL;
+    cond -> dagPrey = NULL;
+    cond -> numPred = NULL;
+    cond -> height = NULL;
+    cond -> capOrgs = 0;
+    cond -> capDag = 0;
+}
+
+void freeCondensation(Condensation* cond) {
+    free(cond -> compOf);
+    free(cond -> memberStart);
+    free(cond -> members);
+    free(cond -> dagStart);
+    free(cond -> dagPrey);
+    free(cond -> numPred);
+    free(cond -> height);
+    initCondensation(cond);
+}
+
+// Make room for a condensation of numOrgs organisms and numEdges relations.
+bool reserveCondensation(Condensation* cond, int numOrgs, int numEdges) {
+    if (numOrgs > cond -> capOrgs || cond -> capOrgs == 0) { // memberStart always has a slot.
+        int newCap = (cond -> capOrgs > 0) ? cond -> capOrgs : 4;
+        while (newCap < numOrgs) {
+            newCap *= 2;
+        }
+        int** arrays[] = {&(cond -> compOf), &(cond -> memberStart), &(cond -> members),
+                          &(cond -> dagStart), &(cond -> numPred), &(cond -> height)};
+        for (int i = 0; i < 6; i++) {
+            int* newArray = (int*)realloc(*arrays[i], (newCap + 1) * sizeof(int));
+            if (newArray == NULL) {
+                return false; // Memory allocation failed.
+            }
+            *arrays[i] = newArray;
+        }
+        cond -> capOrgs = newCap;
+    }
+    if (numEdges > cond -> capDag) {
+        int newCap = (cond -> capDag > 0) ? cond -> capDag : 16;
+        while (newCap < numEdges) {
+            newCap *= 2;
+        }
+        int* newDag = (int*)realloc(cond -> dagPrey, newCap * sizeof(int));
+        if (newDag == NULL) {
+            return false; // Memory allocation failed.
+        }
+        cond -> dagPrey = newDag;
+        cond -> capDag = newCap;
+    }
+    return true;
+}
+
+void initReachIndex(ReachIndex* reach) {
+    reach -> version = 0;
+    reach -> closure = NULL;
+    reach -> rowWords = 0;
+    reach -> capClosure = 0;
+    reach -> rank = NULL;
+    reach -> low = NULL;
+    reach -> high = NULL;
+    reach -> stamps = NULL;
+    reach -> stack = NULL;
+    reach -> lastQuery = 0;
+    reach -> capComps = 0;
+}
+
+void freeReachIndex(ReachIndex* reach) {
+    free(reach -> closure);
+    free(reach -> rank);
+    free(reach -> low);
+    free(reach -> high);
+    free(reach -> stamps);
+    free(reach -> stack);
+    initReachIndex(reach);
+}
+
+// Make room for the labels of numComps components.
+bool reserveReachIndex(ReachIndex* reach, int numComps) {
+    if (numComps <= reach -> capComps) {
+        return true;
+    }
+    int newCap = (reach -> capComps > 0) ? reach -> capComps : 4;
+    while (newCap < numComps) {
+        newCap *= 2;
+    }
+    int** arrays[] = {&(reach -> rank), &(reach -> low), &(reach -> high), &(reach -> stamps), &(reach -> stack)};
+    for (int i = 0; i < 5; i++) {
+        int size = (i < 3) ? REACH_LABELS * newCap : newCap;
+        int* newArray = (int*)realloc(*arrays[i], size * sizeof(int));
+        if (newArray == NULL) {
+            return false; // Memory allocation failed.
+        }
+        *arrays[i] = newArray;
+    }
+    reach -> capComps = newCap;
+    return true;
+}
+
+void initChainCounts(ChainCounts* chains) {
+    chains -> upMod = NULL;
+    chains -> upEst = NULL;
+    chains -> downMod = NULL;
+    chains -> downEst = NULL;
+    chains -> totalMod = 0;
+    chains -> totalEst = 0.0L;
+    chains -> capComps = 0;
+}
+
+void freeChainCounts(ChainCounts* chains) {
+    free(chains -> upMod);
+    free(chains -> upEst);
+    free(chains -> downMod);
+    free(chains -> downEst);
+    initChainCounts(chains);
+}
+
+// Make room for the chain counts of numComps components.
+bool reserveChainCounts(ChainCounts* chains, int numComps) {
+    if (numComps <= chains -> capComps) {
+        return true;
+    }
+    int newCap = (chains -> capComps > 0) ? chains -> capComps : 4;
+    while (newCap < numComps) {
+        newCap *= 2;
+    }
+    uint64_t** mods[] = {&(chains -> upMod), &(chains -> downMod)};
+    long double** ests[] = {&(chains -> upEst), &(chains -> downEst)};
+    for (int k = 0; k < 2; k++) {
+        uint64_t* newMod = (uint64_t*)realloc(*mods[k], newCap * sizeof(uint64_t));
+        if (newMod != NULL) {
+            *mods[k] = newMod;
+        }
+        long double* newEst = (long double*)realloc(*ests[k], newCap * sizeof(long double));
+        if (newEst != NULL) {
+            *ests[k] = newEst;
+        }
+        if (newMod == NULL || newEst == NULL) {
+            return false; // Memory allocation failed.
+        }
+    }
+    chains -> capComps = newCap;
+    return true;
+}
+
+void initWeb(Web* web) {
+    web -> orgs = NULL;
+    web -> numOrgs = 0;
+    web -> numExtinct = 0;
+    web -> capOrgs = 0;
+    web -> liveTree = NULL;
+    web -> capLiveTree = 0;
+    web -> liveTreeValid = false;
+    web -> links = NULL;
+    initBuckets(&(web -> byNumPred));
+    initBuckets(&(web -> byNumPrey));
+    web -> heightsValid = true;
+    initCondensation(&(web -> cond));
+    web -> levels = NULL;
+    web -> nextLevels = NULL;
+    web -> capLevels = 0;
+    initReachIndex(&(web -> reach));
+    initChainCounts(&(web -> chains));
+    web -> version = 1;
+    web -> work = NULL;
+    web -> capWork = 0;
+    web -> edges = NULL;
+    web -> endEdges = 0;
+    web -> capEdges = 0;
+    web -> numEdges = 0;
+    web -> freedEdges = 0;
+    web -> spare = NULL;
+    web -> capSpare = 0;
+    web -> edgeKeys = NULL;
+    web -> capEdgeKeys = 0;
+    web -> numEdgeKeys = 0;
+    web -> names = NULL;
+    web -> lenNames = 0;
+    web -> capNames = 0;
+    web -> nameIndex = NULL;
+    web -> capNameIndex = 0;
+    web -> numNames = 0;
+    web -> snapshot = NULL;
+    web -> lenSnapshot = 0;
+}
+
+bool reserveOrgs(Web* web, int minCap) {
+
+    // Nothing to do if the array is already large enough.
+    if (minCap <= web -> capOrgs) {
+        return true;
+    }
+
+    // Grow geometrically so that appending N organisms costs amortized O(1) each.
+    int newCap = (web -> capOrgs > 0) ? web -> capOrgs : 4;
+    while (newCap < minCap) {
+        newCap *= 2;
+    }
+
+    // Work out every new size up front. Each array is swapped in as soon as it
+    // grows (the old pointer may be gone), but capOrgs only moves once all of
+    // them have, so a failed reserve leaves the web exactly as it was: every
+    // array still holds at least capOrgs entries with their contents intact.
+    size_t orgBytes = (size_t)newCap * sizeof(Org);
+    size_t linkBytes = (size_t)newCap * sizeof(OrgLinks);
+    size_t bucketBytes = (size_t)newCap * sizeof(int);
+
+    Org* newOrgs = (Org*)realloc(web -> orgs, orgBytes);
+    if (newOrgs == NULL) {
+        return false; // Memory allocation failed.
+    }
+    web -> orgs = newOrgs;
+
+    OrgLinks* newLinks = (OrgLinks*)realloc(web -> links, linkBytes);
+    if (newLinks == NULL) {
+        return false; // Memory allocation failed.
+    }
+    web -> links = newLinks;
+
+    if (!reserveBucketLinks(&(web -> byNumPred), bucketBytes) || !reserveBucketLinks(&(web -> byNumPrey), bucketBytes)) {
+        return false; // Memory allocation failed.
+    }
+
+    web -> capOrgs = newCap;
+    return true;
+}
+
+bool reserveEdges(Web* web, int minCap) {
+
+    // Nothing to do if the arena is already large enough.
+    if (minCap <= web -> capEdges) {
+        return true;
+    }
+
+    // Grow geometrically, same as the organism array.
+    int newCap = (web -> capEdges > 0) ? web -> capEdges : 16;
+    while (newCap < minCap) {
+        newCap *= 2;
+    }
+
+    int* newEdges = (int*)realloc(web -> edges, newCap * sizeof(int));
+    if (newEdges == NULL) {
+        return false; // Memory allocation failed.
+    }
+
+    web -> edges = newEdges;
+    web -> capEdges = newCap;
+    return true;
+}
+
+// Pointer to the first prey index of an organism's run in the edge arena.
+int* preyOf(Web* web, int orgInd) {
+    return web -> edges + web -> orgs[orgInd].preyStart;
+}
+
+// Pointer to the first predator index of an organism's run in the edge arena.
+int* predsOf(Web* web, int orgInd) {
+    return web -> edges + web -> links[orgInd].predStart;
+}
+
+bool reserveWork(Web* web, int minCap) {
+    if (minCap <= web -> capWork) {
+        return true;
+    }
+    int newCap = (web -> capWork > 0) ? web -> capWork : 64;
+    while (newCap < minCap) {
+        newCap *= 2;
+    }
+    int* newWork = (int*)realloc(web -> work, newCap * sizeof(int));
+    if (newWork == NULL) {
+        return false; // Memory allocation failed.
+    }
+    web -> work = newWork;
+    web -> capWork = newCap;
+    return true;
+}
+
+// Make room in the spare arena that rebuilds lay the relations out into.
+// The arena they replace becomes the next spare, so repeated rebuilds stop
+// allocating once the web has settled in size.
+bool reserveSpare(Web* web, int minCap) {
+    if (minCap <= web -> capSpare) {
+        return true;
+    }
+    free(web -> spare); // Its contents are never needed.
+    web -> spare = (int*)malloc((size_t)minCap * sizeof(int));
+    web -> capSpare = (web -> spare != NULL) ? minCap : 0;
+    return web -> spare != NULL;
+}
+
+// Swap the spare arena in as the edge arena once it holds numSlots slots.
+void swapSpare(Web* web, int numSlots) {
+    int* oldEdges = web -> edges;
+    int oldCap = web -> capEdges;
+    web -> edges = web -> spare;
+    web -> capEdges = web -> capSpare;
+    web -> endEdges = numSlots;
+    web -> freedEdges = 0;
+    web -> spare = oldEdges;
+    web -> capSpare = oldCap;
+}
+
+// An organism's name, stored once in the interned name pool.
+char* orgName(Web* web, int orgInd) {
+    return web -> names + web -> orgs[orgInd].nameOff;
+}
+
+// Rebuild the tree of live organisms in O(n), with room for every slot the
+// organism array can hold so that appends rarely outgrow it.
+bool buildLiveTree(Web* web) {
+    if (web -> capLiveTree < web -> capOrgs + 1) {
+        int* newTree = (int*)realloc(web -> liveTree, ((size_t)web -> capOrgs + 1) * sizeof(int));
+        if (newTree == NULL) {
+            return false; // Memory allocation failed.
+        }
+        web -> liveTree = newTree;
+        web -> capLiveTree = web -> capOrgs + 1;
+    }
+    int* tree = web -> liveTree;
+    for (int i = 1; i <= web -> numOrgs; i++) {
+        tree[i] = web -> orgs[i - 1].extinct ? 0 : 1;
+    }
+    for (int i = 1; i <= web -> numOrgs; i++) {
+        int parent = i + (i & -i);
+        if (parent <= web -> numOrgs) {
+            tree[parent] += tree[i];
+        }
+    }
+    web -> liveTreeValid = true;
+    return true;
+}
+
+// Count a slot that just went extinct out of the tree, in O(log n).
+void dropFromLiveTree(Web* web, int orgInd) {
+    if (!web -> liveTreeValid) {
+        return;
+    }
+    for (int i = orgInd + 1; i <= web -> numOrgs; i += i & -i) {
+        web -> liveTree[i]--;
+    }
+}
+
+// Count the slot just appended at the end (numOrgs - 1) into the tree, in
+// O(log n): its entry covers it and the slots just below, already counted.
+void appendToLiveTree(Web* web) {
+    int i = web -> numOrgs;
+    if (!web -> liveTreeValid) {
+        return;
+    }
+    if (i >= web -> capLiveTree) {
+        web -> liveTreeValid = false; // Rebuilt larger on the next select.
+        return;
+    }
+    int count = 1;
+    for (int j = i - 1; j > i - (i & -i); j -= j & -j) {
+        count += web -> liveTree[j];
+    }
+    web -> liveTree[i] = count;
+}
+
+// The organism with the given index as printed and typed by the user: the
+// rank-th live organism, which is its index once the web is compacted.
+// Found in O(log n) through the tree, so tombstones never force a
+// compaction. Returns -1 if there is no such organism.
+int selectLiveOrg(Web* web, int rank) {
+    if (rank < 0 || rank >= web -> numOrgs - web -> numExtinct) {
+        return -1;
+    }
+    if (web -> numExtinct == 0) {
+        return rank;
+    }
+    if (!web -> liveTreeValid && !buildLiveTree(web)) {
+        for (int i = 0; i < web -> numOrgs; i++) { // Out of memory: count them off.
+            if (!web -> orgs[i].extinct && rank-- == 0) {
+                return i;
+            }
+        }
+        return -1;
+    }
+    int pos = 0;
+    int step = 1;
+    while (2 * step <= web -> numOrgs) {
+        step *= 2;
+    }
+    for (; step > 0; step /= 2) {
+        if (pos + step <= web -> numOrgs && web -> liveTree[pos + step] <= rank) {
+            pos += step;
+            rank -= web -> liveTree[pos];
+        }
+    }
+    return pos;
+}
+
+// FNV-1a hash of a name.
+uint32_t nameHash(const char* name) {
+    uint32_t hash = 2166136261u;
+    for (const char* c = name; *c != '\0'; c++) {
+        hash = (hash ^ (unsigned char)*c) * 16777619u;
+    }
+    return hash;
+}
+
+// Slot holding the name in the name index, or the empty slot where it belongs.
+int findNameSlot(Web* web, const char* name, uint32_t hash) {
+    int mask = web -> capNameIndex - 1;
+    int slot = (int)hash & mask;
+    while (web -> nameIndex[slot].nameOff != -1) {
+        NameEntry* entry = &(web -> nameIndex[slot]);
+        if (entry -> hash == hash && strcmp(web -> names + entry -> nameOff, name) == 0) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+// Mark a name index slot empty. Every field is set, so that no stale bytes
+// reach a snapshot.
+void emptyNameEntry(NameEntry* entry) {
+    entry -> nameOff = -1;
+    entry -> hash = 0;
+    entry -> orgInd = -1;
+    entry -> refs = 0;
+}
+
+bool growNameIndex(Web* web) {
+    int newCap = (web -> capNameIndex > 0) ? 2 * web -> capNameIndex : 16;
+    NameEntry* newIndex = (NameEntry*)malloc(newCap * sizeof(NameEntry));
+    if (newIndex == NULL) {
+        return false; // Memory allocation failed.
+    }
+    for (int i = 0; i < newCap; i++) {
+        emptyNameEntry(&(newIndex[i]));
+    }
+
+    // Move the entries over; names are unique so no comparisons are needed.
+    for (int i = 0; i < web -> capNameIndex; i++) {
+        NameEntry* entry = &(web -> nameIndex[i]);
+        if (entry -> nameOff != -1) {
+            int slot = (int)entry -> hash & (newCap - 1);
+            while (newIndex[slot].nameOff != -1) {
+                slot = (slot + 1) & (newCap - 1);
+            }
+            newIndex[slot] = *entry;
+        }
+    }
+
+    free(web -> nameIndex);
+    web -> nameIndex = newIndex;
+    web -> capNameIndex = newCap;
+    return true;
+}
+
+// Returns the name index entry for a name, adding the name to the pool the
+// first time it is seen. Returns NULL if memory allocation failed.
+NameEntry* internName(Web* web, const char* name) {
+
+    // Keep the load factor at or below one half.
+    if (2 * (web -> numNames + 1) > web -> capNameIndex) {
+        if (!growNameIndex(web)) {
+            return NULL;
+        }
+    }
+
+    uint32_t hash = nameHash(name);
+    int slot = findNameSlot(web, name, hash);
+    NameEntry* entry = &(web -> nameIndex[slot]);
+    if (entry -> nameOff != -1) {
+        return entry; // Already interned.
+    }
+
+    // Append the name to the pool, growing it geometrically.
+    int len = (int)strlen(name) + 1;
+    if (web -> lenNames + len > web -> capNames) {
+        int newCap = (web -> capNames > 0) ? web -> capNames : 256;
+        while (newCap < web -> lenNames + len) {
+            newCap *= 2;
+        }
+        char* newNames = (char*)realloc(web -> names, newCap);
+        if (newNames == NULL) {
+            return NULL; // Memory allocation failed.
+        }
+        web -> names = newNames;
+        web -> capNames = newCap;
+    }
+    memcpy(web -> names + web -> lenNames, name, len);
+
+    entry -> nameOff = web -> lenNames;
+    entry -> hash = hash;
+    entry -> orgInd = -1;
+    entry -> refs = 0;
+    web -> lenNames += len;
+    web -> numNames++;
+    return entry;
+}
+
+// Index of the organism with the given name (the lowest index if several
+// organisms share it), or -1 if there is none.
+int findOrgByName(Web* web, const char* name) {
+    if (web -> capNameIndex == 0) {
+        return -1;
+    }
+    NameEntry* entry = &(web -> nameIndex[findNameSlot(web, name, nameHash(name))]);
+    return (entry -> nameOff == -1) ? -1 : entry -> orgInd;
+}
+
+// Hash set key for a relation; never 0 since the predator is stored off by one.
+uint64_t edgeKey(int predInd, int preyInd) {
+    return ((uint64_t)(predInd + 1) << 32) | (uint32_t)preyInd;
+}
+
+// First hash slot to probe for a key (Fibonacci hashing).
+int edgeKeySlot(uint64_t key, int capEdgeKeys) {
+    return (int)((key * 0x9E3779B97F4A7C15ULL) >> 32) & (capEdgeKeys - 1);
+}
+
+bool hasRelation(Web* web, int predInd, int preyInd) {
+
+    // A web mapped from a snapshot is not indexed until it is detached, so
+    // scan the predator's prey run instead (an empty web has no runs).
+    if (web -> capEdgeKeys == 0) {
+        int* prey = preyOf(web, predInd);
+        for (int j = 0; j < web -> orgs[predInd].numPrey; j++) {
+            if (prey[j] == preyInd) {
+                return true;
+            }
+        }
+        return false;
+    }
+    uint64_t key = edgeKey(predInd, preyInd);
+    int mask = web -> capEdgeKeys - 1;
+    for (int slot = edgeKeySlot(key, web -> capEdgeKeys); web -> edgeKeys[slot] != 0; slot = (slot + 1) & mask) {
+        if (web -> edgeKeys[slot] == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void insertEdgeKey(Web* web, uint64_t key) {
+    int mask = web -> capEdgeKeys - 1;
+    int slot = edgeKeySlot(key, web -> capEdgeKeys);
+    while (web -> edgeKeys[slot] != 0 && web -> edgeKeys[slot] != key) {
+        slot = (slot + 1) & mask;
+    }
+    if (web -> edgeKeys[slot] == 0) {
+        web -> edgeKeys[slot] = key;
+        web -> numEdgeKeys++;
+    }
+}
+
+bool rebuildEdgeIndex(Web* web, int minEdges) {
+
+    // Keep the load factor at or below one half.
+    int newCap = 16;
+    while (newCap < 2 * minEdges) {
+        newCap *= 2;
+    }
+
+    uint64_t* newKeys = (uint64_t*)calloc(newCap, sizeof(uint64_t));
+    if (newKeys == NULL) {
+        return false; // Memory allocation failed.
+    }
+    free(web -> edgeKeys);
+    web -> edgeKeys = newKeys;
+    web -> capEdgeKeys = newCap;
+    web -> numEdgeKeys = 0;
+
+    // Re-insert every relation currently stored in the arena.
+    for (int i = 0; i < web -> numOrgs; i++) {
+        int* prey = preyOf(web, i);
+        for (int j = 0; j < web -> orgs[i].numPrey; j++) {
+            insertEdgeKey(web, edgeKey(i, prey[j]));
+        }
+    }
+    return true;
+}
+
+bool compactEdges(Web* web) {
+
+    // Nothing to reclaim if no run was ever abandoned or over-reserved.
+    if (web -> endEdges == 2 * web -> numEdges) {
+        return true;
+    }
+
+    if (!reserveSpare(web, 2 * web -> numEdges)) {
+        return false; // Memory allocation failed.
+    }
+    int* newEdges = web -> spare;
+
+    // Lay the runs back to back in organism order (plain CSR, no slack),
+    // each organism's prey run followed by its predator run.
+    int offset = 0;
+    for (int i = 0; i < web -> numOrgs; i++) {
+        Org* org = &(web -> orgs[i]);
+        OrgLinks* link = &(web -> links[i]);
+        if (org -> numPrey > 0) {
+            memcpy(newEdges + offset, preyOf(web, i), org -> numPrey * sizeof(int));
+        }
+        org -> preyStart = offset;
+        org -> preyCap = org -> numPrey;
+        offset += org -> numPrey;
+
+        if (link -> numPred > 0) {
+            memcpy(newEdges + offset, predsOf(web, i), link -> numPred * sizeof(int));
+        }
+        link -> predStart = offset;
+        link -> predCap = link -> numPred;
+        offset += link -> numPred;
+    }
+
+    swapSpare(web, offset);
+    return true;
+}
+
+// Double the slots reserved for a prey or predator run whose start and
+// capacity are stored at pStart and pCap and which holds num indices.
+bool growRun(Web* web, int* pStart, int* pCap, int num) {
+    int newCap = (*pCap > 0) ? 2 * *pCap : 2;
+
+    if (*pCap > 0 && *pStart + *pCap == web -> endEdges) {
+        // The run is the last one in the arena, so it can grow in place.
+        if (!reserveEdges(web, *pStart + newCap)) {
+            return false;
+        }
+    } else {
+        // Move the run to the end of the arena; its old slots become garbage.
+        if (!reserveEdges(web, web -> endEdges + newCap)) {
+            return false;
+        }
+        if (num > 0) {
+            memcpy(web -> edges + web -> endEdges, web -> edges + *pStart, num * sizeof(int));
+        }
+        web -> freedEdges += *pCap;
+        *pStart = web -> endEdges;
+    }
+
+    web -> endEdges = *pStart + newCap;
+    *pCap = newCap;
+    return true;
+}
+
+// Rebuild everything derived from the prey runs in one fused kernel: the
+// predator runs (laid out with the prey runs as plain CSR in the spare
+// arena), the degree buckets and the producer prey counts. It reads the
+// relations twice, once to count and once to place, and both passes run
+// across threads on large webs. Heights are left as they are.
+bool rebuildLinks(Web* web) {
+    int numOrgs = web -> numOrgs;
+    Org* orgs = web -> orgs;
+    OrgLinks* links = web -> links;
+    int numWords = (numOrgs + 63) / 64;
+    if (!reserveSpare(web, 2 * web -> numEdges) || !reserveWork(web, (numOrgs > 2 * numWords) ? numOrgs : 2 * numWords)) {
+        return false; // Memory allocation failed.
+    }
+
+    // Producers as a bitset in the scratch worklist: testing a prey reads one
+    // bit instead of its whole Org, so the tests stay in cache on large webs.
+    uint64_t* producers = (uint64_t*)web -> work;
+    for (int w = 0; w < numWords; w++) {
+        producers[w] = 0;
+    }
+    for (int i = 0; i < numOrgs; i++) {
+        if (orgs[i].numPrey == 0) {
+            producers[i >> 6] |= 1ull << (i & 63);
+        }
+    }
+
+    // Spread the passes over the relations across threads only when that
+    // pays for the atomic updates they need, and not from inside a batch
+    // worker (which is already one of several threads).
+    bool parallel = false;
+#ifdef _OPENMP
+    parallel = (web -> numEdges >= PARALLEL_MIN_EDGES && omp_get_max_threads() > 1 && !omp_in_parallel());
+#endif
+
+    // First pass over the relations: every organism's predators, producer
+    // prey and the largest number of prey, all at once. Predator counts are
+    // scattered, so threads add them atomically.
+    for (int i = 0; i < numOrgs; i++) {
+        links[i].numPred = 0;
+    }
+    int maxNumPrey = 0;
+    if (parallel) {
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, 1024) reduction(max: maxNumPrey)
+        for (int i = 0; i < numOrgs; i++) {
+            int* prey = preyOf(web, i);
+            int numProducerPrey = 0;
+            for (int j = 0; j < orgs[i].numPrey; j++) {
+                #pragma omp atomic
+                links[prey[j]].numPred++;
+                numProducerPrey += (int)((producers[prey[j] >> 6] >> (prey[j] & 63)) & 1);
+            }
+            links[i].numProducerPrey = numProducerPrey;
+            if (orgs[i].numPrey > maxNumPrey) {
+                maxNumPrey = orgs[i].numPrey;
+            }
+        }
+#endif
+    } else {
+        for (int i = 0; i < numOrgs; i++) {
+            int* prey = preyOf(web, i);
+            int numProducerPrey = 0;
+            for (int j = 0; j < orgs[i].numPrey; j++) {
+                links[prey[j]].numPred++;
+                numProducerPrey += (int)((producers[prey[j] >> 6] >> (prey[j] & 63)) & 1);
+            }
+            links[i].numProducerPrey = numProducerPrey;
+            if (orgs[i].numPrey > maxNumPrey) {
+                maxNumPrey = orgs[i].numPrey;
+            }
+        }
+    }
+
+    // Place each organism's prey run followed by its predator run in the
+    // spare arena. The new prey offsets replace the bitset in the scratch
+    // worklist and wait there until the old runs have been copied.
+    int* newPreyStart = web -> work;
+    int maxNumPred = 0;
+    int offset = 0;
+    for (int i = 0; i < numOrgs; i++) {
+        OrgLinks* link = &(links[i]);
+        newPreyStart[i] = offset;
+        offset += orgs[i].numPrey;
+        link -> predStart = offset;
+        link -> predCap = link -> numPred;
+        offset += link -> numPred;
+        if (link -> numPred > maxNumPred) {
+            maxNumPred = link -> numPred;
+        }
+        link -> numPred = 0;
+    }
+    if (!reserveBuckets(&(web -> byNumPred), maxNumPred) || !reserveBuckets(&(web -> byNumPrey), maxNumPrey)) {
+        return false;
+    }
+
+    // Second pass over the relations: copy each prey run and append the
+    // organism to each of its prey's predator runs. Threads claim predator
+    // slots atomically, so runs are not sorted by predator in that case.
+    int* newEdges = web -> spare;
+    if (parallel) {
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (int i = 0; i < numOrgs; i++) {
+            int* prey = preyOf(web, i);
+            int* newPrey = newEdges + newPreyStart[i];
+            for (int j = 0; j < orgs[i].numPrey; j++) {
+                OrgLinks* preyLink = &(links[prey[j]]);
+                int slot;
+                #pragma omp atomic capture
+                slot = preyLink -> numPred++;
+                newEdges[preyLink -> predStart + slot] = i;
+                newPrey[j] = prey[j];
+            }
+        }
+#endif
+    } else {
+        for (int i = 0; i < numOrgs; i++) {
+            int* prey = preyOf(web, i);
+            int* newPrey = newEdges + newPreyStart[i];
+            for (int j = 0; j < orgs[i].numPrey; j++) {
+                OrgLinks* preyLink = &(links[prey[j]]);
+                newEdges[preyLink -> predStart + preyLink -> numPred++] = i;
+                newPrey[j] = prey[j];
+            }
+        }
+    }
+    for (int i = 0; i < numOrgs; i++) {
+        orgs[i].preyStart = newPreyStart[i];
+        orgs[i].preyCap = orgs[i].numPrey;
+    }
+    swapSpare(web, offset);
+
+    // Refill the degree buckets, back to front so each lists ascending indices.
+    for (int d = 0; d < web -> byNumPred.capHeads; d++) {
+        web -> byNumPred.heads[d] = -1;
+    }
+    for (int d = 0; d < web -> byNumPrey.capHeads; d++) {
+        web -> byNumPrey.heads[d] = -1;
+    }
+    web -> byNumPred.maxDeg = 0;
+    web -> byNumPrey.maxDeg = 0;
+    for (int i = numOrgs - 1; i >= 0; i--) {
+        if (!orgs[i].extinct) {
+            linkBucket(&(web -> byNumPred), i, links[i].numPred);
+            linkBucket(&(web -> byNumPrey), i, orgs[i].numPrey);
+        }
+    }
+    return true;
+}
+
+// Push an organism onto the binary min-heap of (old height, organism) pairs
+// kept in the scratch worklist.
+bool pushHeight(Web* web, int* pNumHeap, int orgInd) {
+    if (!reserveWork(web, 2 * (*pNumHeap + 1))) {
+        return false;
+    }
+    int* heap = web -> work;
+    int key = web -> links[orgInd].height;
+    int pos = (*pNumHeap)++;
+    while (pos > 0 && heap[2 * ((pos - 1) / 2)] > key) {
+        heap[2 * pos] = heap[2 * ((pos - 1) / 2)];
+        heap[2 * pos + 1] = heap[2 * ((pos - 1) / 2) + 1];
+        pos = (pos - 1) / 2;
+    }
+    heap[2 * pos] = key;
+    heap[2 * pos + 1] = orgInd;
+    return true;
+}
+
+// Pop the organism with the lowest old height off the heap.
+int popHeight(Web* web, int* pNumHeap) {
+    int* heap = web -> work;
+    int orgInd = heap[1];
+    int numHeap = --(*pNumHeap);
+    int key = heap[2 * numHeap];
+    int last = heap[2 * numHeap + 1];
+    int pos = 0;
+    while (2 * pos + 1 < numHeap) {
+        int child = 2 * pos + 1;
+        if (child + 1 < numHeap && heap[2 * (child + 1)] < heap[2 * child]) {
+            child++;
+        }
+        if (heap[2 * child] >= key) {
+            break;
+        }
+        heap[2 * pos] = heap[2 * child];
+        heap[2 * pos + 1] = heap[2 * child + 1];
+        pos = child;
+    }
+    heap[2 * pos] = key;
+    heap[2 * pos + 1] = last;
+    return orgInd;
+}
+
+// Bring heights up to date after the given organisms gained or lost prey,
+// touching only them and the ancestors whose heights actually change.
+// Organisms are settled in order of their old heights: every prey is lower
+// than its predators, so each one is final by the time its predators are
+// recomputed, and each ancestor changes at most once. A height of at least the
+// number of organisms can only come from a feeding cycle, which (like a failed
+// allocation) leaves the heights to a full recompute.
+void updateHeights(Web* web, int* orgInds, int numOrgInds) {
+    if (!web -> heightsValid) {
+        return; // A full recompute is already pending.
+    }
+    int numHeap = 0;
+    for (int i = 0; i < numOrgInds; i++) {
+        if (!pushHeight(web, &numHeap, orgInds[i])) {
+            web -> heightsValid = false;
+            return;
+        }
+    }
+
+    int numLive = web -> numOrgs - web -> numExtinct;
+    while (numHeap > 0) {
+        int cur = popHeight(web, &numHeap);
+
+        // One more than the tallest remaining prey.
+        int* prey = preyOf(web, cur);
+        int newHeight = 0;
+        for (int i = 0; i < web -> orgs[cur].numPrey; i++) {
+            if (web -> links[prey[i]].height + 1 > newHeight) {
+                newHeight = web -> links[prey[i]].height + 1;
+            }
+        }
+        if (newHeight == web -> links[cur].height) {
+            continue; // Another food chain holds it where it was.
+        }
+        if (newHeight >= numLive) {
+            web -> heightsValid = false;
+            return;
+        }
+
+        // Only predators this organism could hold up need another look: on
+        // a rise the ones not already above it, on a drop the ones resting
+        // exactly on its old height.
+        int oldHeight = web -> links[cur].height;
+        web -> links[cur].height = newHeight;
+        int numPred = web -> links[cur].numPred;
+        for (int i = 0; i < numPred; i++) {
+            int predInd = predsOf(web, cur)[i];
+            int predHeight = web -> links[predInd].height;
+            bool affected = (newHeight > oldHeight) ? (predHeight <= newHeight) : (predHeight == oldHeight + 1);
+            if (affected && !pushHeight(web, &numHeap, predInd)) {
+                web -> heightsValid = false;
+                return;
+            }
+        }
+    }
+}
+
+// Recompute every height in O(V + E) by visiting organisms in topological
+// order, prey before predators (Kahn's algorithm). Organisms on a feeding
+// cycle, or eating from one, are never reached and are left at height -1;
+// heights stay marked stale in that case. Returns false on allocation failure.
+bool recomputeHeights(Web* web) {
+    int numOrgs = web -> numOrgs;
+    if (!reserveWork(web, 2 * numOrgs)) {
+        return false;
+    }
+
+    // The first half of the scratch holds each organism's prey still to be
+    // visited, the second half the queue of organisms ready to be visited.
+    int* numLeft = web -> work;
+    int* queue = web -> work + numOrgs;
+    int head = 0;
+    int tail = 0;
+    for (int i = 0; i < numOrgs; i++) {
+        numLeft[i] = web -> orgs[i].numPrey;
+        web -> links[i].height = (numLeft[i] == 0) ? 0 : -1;
+        if (numLeft[i] == 0) {
+            queue[tail++] = i;
+        }
+    }
+
+    while (head < tail) {
+        int cur = queue[head++];
+        int newHeight = web -> links[cur].height + 1;
+        int* preds = predsOf(web, cur);
+        for (int i = 0; i < web -> links[cur].numPred; i++) {
+            OrgLinks* predLink = &(web -> links[preds[i]]);
+            if (predLink -> height < newHeight) {
+                predLink -> height = newHeight;
+            }
+            if (--numLeft[preds[i]] == 0) {
+                queue[tail++] = preds[i];
+            }
+        }
+    }
+
+    // Anything left unvisited waits on a cycle.
+    for (int i = 0; i < numOrgs; i++) {
+        if (numLeft[i] > 0) {
+            web -> links[i].height = -1;
+        }
+    }
+    web -> heightsValid = (tail == numOrgs);
+    return true;
+}
+
+// Condense the web into its strongly connected components in O(V + E) with
+// an iterative Tarjan search along the prey runs, so that feeding cycles of
+// any length cannot overflow the call stack. Tarjan emits a component only
+// after every component it eats, which numbers them prey-first; the heights,
+// apex and producer components of the condensed DAG follow in one more pass.
+// Returns false on allocation failure.
+bool condenseWeb(Web* web) {
+    int numOrgs = web -> numOrgs;
+    Condensation* cond = &(web -> cond);
+    if (!reserveCondensation(cond, numOrgs, web -> numEdges) || !reserveWork(web, 5 * numOrgs)) {
+        return false;
+    }
+
+    // Scratch: discovery order, lowest reachable discovery order, the stack
+    // of organisms not yet assigned a component, and the explicit call stack
+    // (organism and position in its prey run) replacing recursion.
+    int* order = web -> work;
+    int* low = order + numOrgs;
+    int* open = low + numOrgs;
+    int* callOrg = open + numOrgs;
+    int* callPos = callOrg + numOrgs;
+    int* compOf = cond -> compOf;
+    for (int i = 0; i < numOrgs; i++) {
+        order[i] = -1;
+        compOf[i] = -1;
+    }
+
+    int numOrdered = 0;
+    int numOpen = 0;
+    int numComps = 0;
+    for (int root = 0; root < numOrgs; root++) {
+        if (order[root] != -1) {
+            continue;
+        }
+        int numCalls = 0;
+        order[root] = low[root] = numOrdered++;
+        open[numOpen++] = root;
+        callOrg[numCalls] = root;
+        callPos[numCalls++] = 0;
+
+        while (numCalls > 0) {
+            int cur = callOrg[numCalls - 1];
+            if (callPos[numCalls - 1] < web -> orgs[cur].numPrey) {
+                int prey = preyOf(web, cur)[callPos[numCalls - 1]++];
+                if (order[prey] == -1) {
+                    // Descend into the prey.
+                    order[prey] = low[prey] = numOrdered++;
+                    open[numOpen++] = prey;
+                    callOrg[numCalls] = prey;
+                    callPos[numCalls++] = 0;
+                } else if (compOf[prey] == -1 && order[prey] < low[cur]) {
+                    low[cur] = order[prey]; // The prey is still open: same cycle.
+                }
+                continue;
+            }
+
+            // Every prey is done: return to the caller, closing a component
+            // if nothing deeper reaches above this organism.
+            numCalls--;
+            if (numCalls > 0 && low[cur] < low[callOrg[numCalls - 1]]) {
+                low[callOrg[numCalls - 1]] = low[cur];
+            }
+            if (low[cur] == order[cur]) {
+                int member;
+                do {
+                    member = open[--numOpen];
+                    compOf[member] = numComps;
+                } while (member != cur);
+                numComps++;
+            }
+        }
+    }
+    cond -> numComps = numComps;
+
+    // Group the members by component, in index order (counting sort).
+    for (int c = 0; c <= numComps; c++) {
+        cond -> memberStart[c] = 0;
+    }
+    for (int i = 0; i < numOrgs; i++) {
+        cond -> memberStart[compOf[i] + 1]++;
+    }
+    for (int c = 0; c < numComps; c++) {
+        cond -> memberStart[c + 1] += cond -> memberStart[c];
+    }
+    int* fill = order; // The discovery order is no longer needed.
+    for (int c = 0; c < numComps; c++) {
+        fill[c] = cond -> memberStart[c];
+    }
+    for (int i = 0; i < numOrgs; i++) {
+        cond -> members[fill[compOf[i]]++] = i;
+    }
+
+    // Condensed relations without duplicates, marking each prey component
+    // with the component that last recorded it. Prey components are numbered
+    // lower, so heights are final by the time a predator component is reached.
+    int* lastSeen = low;
+    for (int c = 0; c < numComps; c++) {
+        lastSeen[c] = -1;
+        cond -> numPred[c] = 0;
+    }
+    int numDag = 0;
+    for (int c = 0; c < numComps; c++) {
+        cond -> dagStart[c] = numDag;
+        cond -> height[c] = 0;
+        for (int m = cond -> memberStart[c]; m < cond -> memberStart[c + 1]; m++) {
+            int orgInd = cond -> members[m];
+            int* prey = preyOf(web, orgInd);
+            for (int j = 0; j < web -> orgs[orgInd].numPrey; j++) {
+                int preyComp = compOf[prey[j]];
+                if (preyComp == c || lastSeen[preyComp] == c) {
+                    continue;
+                }
+                lastSeen[preyComp] = c;
+                cond -> dagPrey[numDag++] = preyComp;
+                cond -> numPred[preyComp]++;
+                if (cond -> height[preyComp] + 1 > cond -> height[c]) {
+                    cond -> height[c] = cond -> height[preyComp] + 1;
+                }
+            }
+        }
+    }
+    cond -> dagStart[numComps] = numDag;
+    return true;
+}
+
+// Vore type from the maintained counts: 0 = producer, 1 = herbivore,
+// 2 = omnivore, 3 = carnivore.
+int voreType(Web* web, int orgInd) {
+    int numPrey = web -> orgs[orgInd].numPrey;
+    int numProducerPrey = web -> links[orgInd].numProducerPrey;
+    if (numPrey == 0) {
+        return 0;
+    } else if (numProducerPrey == numPrey) {
+        return 1;
+    } else if (numProducerPrey == 0) {
+        return 3;
+    } else {
+        return 2;
+    }
+}
+
+bool compactWeb(Web* web) {
+
+    // Nothing to do without tombstones.
+    if (web -> numExtinct == 0) {
+        return true;
+    }
+    web -> version++; // Organisms are renumbered.
+    web -> liveTreeValid = false;
+
+    // Map every slot to its index after compaction (-1 for tombstones),
+    // in the scratch worklist.
+    if (!reserveWork(web, web -> numOrgs)) {
+        return false; // Memory allocation failed.
+    }
+    int* newInd = web -> work;
+    int newNumOrgs = 0;
+    for (int i = 0; i < web -> numOrgs; i++) {
+        newInd[i] = web -> orgs[i].extinct ? -1 : newNumOrgs++;
+    }
+
+    // Slide the surviving organisms down over the tombstones.
+    for (int i = 0; i < web -> numOrgs; i++) {
+        if (newInd[i] != -1) {
+            // memcpy keeps the zeroed padding that saveWeb() writes out.
+            memcpy(&(web -> orgs[newInd[i]]), &(web -> orgs[i]), sizeof(Org));
+            web -> links[newInd[i]].height = web -> links[i].height;
+        }
+    }
+    web -> numOrgs = newNumOrgs;
+    web -> numExtinct = 0;
+
+    // Renumber the prey runs in place (extinct prey were already detached).
+    for (int i = 0; i < newNumOrgs; i++) {
+        int* prey = preyOf(web, i);
+        for (int j = 0; j < web -> orgs[i].numPrey; j++) {
+            prey[j] = newInd[prey[j]];
+        }
+    }
+
+    // Renumber the organisms addressed by the name index.
+    for (int i = 0; i < web -> capNameIndex; i++) {
+        NameEntry* entry = &(web -> nameIndex[i]);
+        if (entry -> nameOff != -1 && entry -> orgInd != -1) {
+            entry -> orgInd = newInd[entry -> orgInd];
+        }
+    }
+
+    // Every predator run and key changed along with the indices, so rebuild
+    // the reverse adjacency (packing the arena) and re-index the relations.
+    if (!rebuildLinks(web)) {
+        return false;
+    }
+    return rebuildEdgeIndex(web, web -> numEdges);
+}
+
+// Make room for the fractional trophic levels of numOrgs organisms.
+bool reserveLevels(Web* web, int numOrgs) {
+    if (numOrgs <= web -> capLevels) {
+        return true;
+    }
+    int newCap = (web -> capLevels > 0) ? web -> capLevels : 4;
+    while (newCap < numOrgs) {
+        newCap *= 2;
+    }
+    double* newLevels = (double*)realloc(web -> levels, newCap * sizeof(double));
+    if (newLevels == NULL) {
+        return false; // Memory allocation failed.
+    }
+    web -> levels = newLevels;
+    double* newNextLevels = (double*)realloc(web -> nextLevels, newCap * sizeof(double));
+    if (newNextLevels == NULL) {
+        return false; // Memory allocation failed.
+    }
+    web -> nextLevels = newNextLevels;
+    web -> capLevels = newCap;
+    return true;
+}
+
+// The level of a consumer from the current levels of its prey.
+double preyAverageLevel(Web* web, int orgInd) {
+    int* prey = preyOf(web, orgInd);
+    double sum = 0.0;
+    for (int j = 0; j < web -> orgs[orgInd].numPrey; j++) {
+        sum += web -> levels[prey[j]];
+    }
+    return 1.0 + sum / web -> orgs[orgInd].numPrey;
+}
+
+// One sweep over the members of a feeding cycle, returning the largest change
+// in a level. Serially that is Gauss-Seidel, using each new level as soon as
+// it is known. Built with OpenMP, a large cycle is swept Jacobi-style instead,
+// its rows spread across threads and the new levels copied back afterwards.
+double sweepCycle(Web* web, int* members, int numMembers, bool parallel) {
+    double maxChange = 0.0;
+    if (parallel) {
+#ifdef _OPENMP
+        double* nextLevels = web -> nextLevels;
+        #pragma omp parallel for schedule(dynamic, 1024) reduction(max: maxChange)
+        for (int m = 0; m < numMembers; m++) {
+            int i = members[m];
+            nextLevels[i] = preyAverageLevel(web, i);
+            double change = fabs(nextLevels[i] - web -> levels[i]);
+            if (change > maxChange) {
+                maxChange = change;
+            }
+        }
+        #pragma omp parallel for
+        for (int m = 0; m < numMembers; m++) {
+            web -> levels[members[m]] = nextLevels[members[m]];
+        }
+#endif
+    } else {
+        for (int m = 0; m < numMembers; m++) {
+            int i = members[m];
+            double level = preyAverageLevel(web, i);
+            double change = fabs(level - web -> levels[i]);
+            if (change > maxChange) {
+                maxChange = change;
+            }
+            web -> levels[i] = level;
+        }
+    }
+    return maxChange;
+}
+
+// Fractional trophic levels: 1 for a producer, and one more than the average
+// level of its prey for a consumer. The components of the condensation are
+// solved in prey-first order, so every organism outside a feeding cycle is
+// settled by a single evaluation and only cycles are iterated, until no level
+// moves by TROPHIC_TOLERANCE. Organisms that eat (directly or not) from a
+// cycle with no producer below it have no finite level and get -1. Fills
+// web -> levels and returns false if the scratch space could not be allocated
+// or a cycle did not settle in MAX_TROPHIC_SWEEPS.
+bool computeTrophicLevels(Web* web) {
+    if (!compactWeb(web) || !condenseWeb(web)) {
+        return false;
+    }
+    Condensation* cond = &(web -> cond);
+    if (!reserveLevels(web, web -> numOrgs)) {
+        return false; // Memory allocation failed.
+    }
+
+    bool settled = true;
+    for (int c = 0; c < cond -> numComps; c++) {
+        int* members = cond -> members + cond -> memberStart[c];
+        int numMembers = cond -> memberStart[c + 1] - cond -> memberStart[c];
+
+        // A component without a finite level is a cycle eating nothing
+        // outside itself, or anything eating one.
+        bool unbounded = (numMembers > 1 && cond -> dagStart[c + 1] == cond -> dagStart[c]);
+        for (int e = cond -> dagStart[c]; e < cond -> dagStart[c + 1] && !unbounded; e++) {
+            int preyComp = cond -> dagPrey[e];
+            unbounded = (web -> levels[cond -> members[cond -> memberStart[preyComp]]] < 0.0);
+        }
+        if (unbounded || numMembers == 1) {
+            for (int m = 0; m < numMembers; m++) {
+                int i = members[m];
+                web -> levels[i] = unbounded ? -1.0 : (web -> orgs[i].numPrey == 0) ? 1.0 : preyAverageLevel(web, i);
+            }
+            continue;
+        }
+
+        // Iterate a feeding cycle from level 1 until it settles.
+        bool parallel = false;
+#ifdef _OPENMP
+        parallel = (numMembers >= PARALLEL_MIN_EDGES / 16 && omp_get_max_threads() > 1);
+#endif
+        for (int m = 0; m < numMembers; m++) {
+            web -> levels[members[m]] = 1.0;
+        }
+        int sweep = 0;
+        while (sweep < MAX_TROPHIC_SWEEPS && sweepCycle(web, members, numMembers, parallel) >= TROPHIC_TOLERANCE) {
+            sweep++;
+        }
+        if (sweep == MAX_TROPHIC_SWEEPS) {
+            settled = false;
+        }
+    }
+    return settled;
+}
+
+// Build the reachability index for the web's current version, unless it is
+// already up to date. A small web gets the closure: prey components are
+// numbered first, so each row is the union of its prey's rows and their own
+// bits, in O(C * D / 64) for C components and D condensed relations. A larger
+// one gets labels instead, in O(C + D) each. A labeling ranks the components
+// in the finishing order of one depth-first traversal of the condensed DAG;
+// anything a component reaches ranks lower, no lower than the lowest rank
+// below the component, and has the component among what reaches it. The
+// first labeling is the condensation's own numbering (Tarjan's finishing
+// order); the others traverse roots and prey in different orders.
+bool buildReachIndex(Web* web) {
+    ReachIndex* reach = &(web -> reach);
+    if (reach -> version == web -> version) {
+        return true;
+    }
+    if (!compactWeb(web) || !condenseWeb(web)) {
+        return false;
+    }
+    Condensation* cond = &(web -> cond);
+    int numComps = cond -> numComps;
+    if (numComps <= REACH_CLOSURE_COMPS) {
+        int rowWords = (numComps + 63) / 64;
+        size_t numWords = (size_t)rowWords * numComps;
+        if (numWords > reach -> capClosure || reach -> closure == NULL) {
+            free(reach -> closure);
+            reach -> closure = (uint64_t*)malloc((numWords + 1) * sizeof(uint64_t));
+            reach -> capClosure = (reach -> closure != NULL) ? numWords : 0;
+            if (reach -> closure == NULL) {
+                return false; // Memory allocation failed.
+            }
+        }
+        uint64_t* closure = reach -> closure;
+        for (int c = 0; c < numComps; c++) {
+            uint64_t* row = closure + (size_t)rowWords * c;
+            memset(row, 0, rowWords * sizeof(uint64_t));
+            for (int e = cond -> dagStart[c]; e < cond -> dagStart[c + 1]; e++) {
+                int preyComp = cond -> dagPrey[e];
+                uint64_t* preyRow = closure + (size_t)rowWords * preyComp;
+                for (int w = 0; w <= preyComp / 64; w++) { // Prey only reach lower numbers.
+                    row[w] |= preyRow[w];
+                }
+                row[preyComp / 64] |= (uint64_t)1 << (preyComp % 64);
+            }
+        }
+        reach -> rowWords = rowWords;
+        reach -> version = web -> version;
+        return true;
+    }
+
+    free(reach -> closure); // Too large for the closure.
+    reach -> closure = NULL;
+    reach -> capClosure = 0;
+    if (!reserveReachIndex(reach, numComps) || !reserveWork(web, 2 * numComps)) {
+        return false; // Memory allocation failed.
+    }
+    int* rank = reach -> rank;
+    int* low = reach -> low;
+
+    // First labeling: prey components are numbered first.
+    for (int c = 0; c < numComps; c++) {
+        rank[REACH_LABELS * c] = c;
+        low[REACH_LABELS * c] = c;
+        for (int e = cond -> dagStart[c]; e < cond -> dagStart[c + 1]; e++) {
+            int preyLow = low[REACH_LABELS * cond -> dagPrey[e]];
+            if (preyLow < low[REACH_LABELS * c]) {
+                low[REACH_LABELS * c] = preyLow;
+            }
+        }
+    }
+
+    // Further labelings: iterative traversals taking the roots from the last
+    // one back (or the first one on) and each component's prey starting at a
+    // different position, so the labelings rule out different pairs. A
+    // component is finished once all of its prey are, so their lows are final.
+    int* callComp = web -> work;
+    int* callPos = callComp + numComps; // Prey expanded so far.
+    for (int k = 1; k < REACH_LABELS; k++) {
+        for (int c = 0; c < numComps; c++) {
+            rank[REACH_LABELS * c + k] = -1;
+        }
+        int numFinished = 0;
+        for (int r = 0; r < numComps; r++) {
+            int root = (k % 2 == 1) ? numComps - 1 - r : r;
+            if (rank[REACH_LABELS * root + k] != -1) {
+                continue;
+            }
+            int numCalls = 0;
+            rank[REACH_LABELS * root + k] = -2; // Open.
+            callComp[numCalls] = root;
+            callPos[numCalls++] = 0;
+            while (numCalls > 0) {
+                int c = callComp[numCalls - 1];
+                int numPrey = cond -> dagStart[c + 1] - cond -> dagStart[c];
+                if (callPos[numCalls - 1] < numPrey) {
+                    int e = (callPos[numCalls - 1]++ + (int)(((unsigned)c * 2654435761u >> k) % numPrey)) % numPrey;
+                    int preyComp = cond -> dagPrey[cond -> dagStart[c] + e];
+                    if (rank[REACH_LABELS * preyComp + k] == -1) {
+                        rank[REACH_LABELS * preyComp + k] = -2;
+                        callComp[numCalls] = preyComp;
+                        callPos[numCalls++] = 0;
+                    }
+                    continue;
+                }
+                numCalls--;
+                rank[REACH_LABELS * c + k] = numFinished;
+                low[REACH_LABELS * c + k] = numFinished++;
+                for (int e = cond -> dagStart[c]; e < cond -> dagStart[c + 1]; e++) {
+                    int preyLow = low[REACH_LABELS * cond -> dagPrey[e] + k];
+                    if (preyLow < low[REACH_LABELS * c + k]) {
+                        low[REACH_LABELS * c + k] = preyLow;
+                    }
+                }
+            }
+        }
+    }
+
+    // Highest ranks among what reaches each component, handed down from
+    // predators to prey in decreasing rank order.
+    int* byRank = web -> work;
+    int* high = reach -> high;
+    for (int k = 0; k < REACH_LABELS; k++) {
+        for (int c = 0; c < numComps; c++) {
+            byRank[rank[REACH_LABELS * c + k]] = c;
+            high[REACH_LABELS * c + k] = rank[REACH_LABELS * c + k];
+        }
+        for (int r = numComps - 1; r >= 0; r--) {
+            int c = byRank[r];
+            for (int e = cond -> dagStart[c]; e < cond -> dagStart[c + 1]; e++) {
+                int* preyHigh = &(high[REACH_LABELS * cond -> dagPrey[e] + k]);
+                if (high[REACH_LABELS * c + k] > *preyHigh) {
+                    *preyHigh = high[REACH_LABELS * c + k];
+                }
+            }
+        }
+    }
+
+    for (int c = 0; c < numComps; c++) {
+        reach -> stamps[c] = -1;
+    }
+    reach -> lastQuery = 0;
+    reach -> version = web -> version;
+    return true;
+}
+
+// Whether component fromComp may reach component toComp: false means it
+// certainly does not, true that a search is needed to be sure.
+bool mayReach(Web* web, int fromComp, int toComp) {
+    if (toComp >= fromComp || web -> cond.height[toComp] >= web -> cond.height[fromComp]) {
+        return false;
+    }
+    int* rank = web -> reach.rank + REACH_LABELS * fromComp;
+    int* low = web -> reach.low + REACH_LABELS * fromComp;
+    int* toRank = web -> reach.rank + REACH_LABELS * toComp;
+    int* toLow = web -> reach.low + REACH_LABELS * toComp;
+    int* toHigh = web -> reach.high + REACH_LABELS * toComp;
+    for (int k = 0; k < REACH_LABELS; k++) {
+        if (toRank[k] > rank[k] || toLow[k] < low[k] || rank[k] > toHigh[k]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Whether organism predInd ultimately eats organism preyInd through a chain
+// of relations, answered from an up-to-date reach index: a bit test with the
+// closure, or else the labels, which settle most pairs alone, and a search
+// through the prey components pruned by them, marking visited components with
+// the query number in stamps.
+bool ultimatelyEats(Web* web, int predInd, int preyInd, int* stamps, int* stack, int query) {
+    Condensation* cond = &(web -> cond);
+    int fromComp = cond -> compOf[predInd];
+    int toComp = cond -> compOf[preyInd];
+    if (fromComp == toComp) {
+        // Within a feeding cycle everything eats everything, itself included.
+        return cond -> memberStart[fromComp + 1] - cond -> memberStart[fromComp] > 1;
+    }
+    ReachIndex* reach = &(web -> reach);
+    if (reach -> closure != NULL) {
+        uint64_t word = reach -> closure[(size_t)reach -> rowWords * fromComp + toComp / 64];
+        return (word >> (toComp % 64)) & 1;
+    }
+    if (!mayReach(web, fromComp, toComp)) {
+        return false;
+    }
+    int top = 0;
+    stack[top++] = fromComp;
+    while (top > 0) {
+        int c = stack[--top];
+        for (int e = cond -> dagStart[c]; e < cond -> dagStart[c + 1]; e++) {
+            int preyComp = cond -> dagPrey[e];
+            if (preyComp == toComp) {
+                return true;
+            }
+            if (stamps[preyComp] != query && mayReach(web, preyComp, toComp)) {
+                stamps[preyComp] = query;
+                stack[top++] = preyComp;
+            }
+        }
+    }
+    return false;
+}
+
+// Answer one query, building the reach index first if the web changed.
+// Returns -1 if the index could not be built.
+int queryReach(Web* web, int predInd, int preyInd) {
+    if (!buildReachIndex(web)) {
+        return -1;
+    }
+    ReachIndex* reach = &(web -> reach);
+    if (reach -> lastQuery == INT32_MAX) { // Start the query numbers over.
+        for (int c = 0; c < web -> cond.numComps && reach -> closure == NULL; c++) {
+            reach -> stamps[c] = -1;
+        }
+        reach -> lastQuery = 0;
+    }
+    return ultimatelyEats(web, predInd, preyInd, reach -> stamps, reach -> stack, reach -> lastQuery++);
+}
+
+// Answer many queries at once: answers[k] is 1 if pairs[2k] ultimately eats
+// pairs[2k + 1] and 0 if not. Queries are spread across threads when compiled
+// with OpenMP, each thread searching with its own stamps and stack from the
+// scratch worklist. Returns false if the index or scratch space could not be
+// built.
+bool queryReachBatch(Web* web, int* pairs, int numPairs, char* answers) {
+    if (!buildReachIndex(web)) {
+        return false;
+    }
+    int numThreads = 1;
+#ifdef _OPENMP
+    if (numPairs >= PARALLEL_MIN_EDGES / 16) {
+        numThreads = omp_get_max_threads();
+    }
+#endif
+    int numComps = (web -> reach.closure == NULL) ? web -> cond.numComps : 0; // Only searches need scratch.
+    int64_t numSlots = 2 * (int64_t)numComps * numThreads;
+    if (numSlots > INT32_MAX || !reserveWork(web, (int)numSlots)) {
+        return false; // Memory allocation failed.
+    }
+    for (int i = 0; i < numSlots; i++) {
+        web -> work[i] = -1;
+    }
+
+    if (numThreads > 1) {
+#ifdef _OPENMP
+        #pragma omp parallel num_threads(numThreads)
+        {
+            int* stamps = web -> work + 2 * numComps * omp_get_thread_num();
+            #pragma omp for schedule(dynamic, 256)
+            for (int k = 0; k < numPairs; k++) {
+                answers[k] = ultimatelyEats(web, pairs[2 * k], pairs[2 * k + 1], stamps, stamps + numComps, k);
+            }
+        }
+#endif
+    } else {
+        for (int k = 0; k < numPairs; k++) {
+            answers[k] = ultimatelyEats(web, pairs[2 * k], pairs[2 * k + 1], web -> work, web -> work + numComps, k);
+        }
+    }
+    return true;
+}
+
+// Sum of two counts modulo CHAIN_MOD = 2^61 - 1.
+uint64_t addChainMod(uint64_t a, uint64_t b) {
+    uint64_t sum = a + b; // Below 2^62.
+    sum = (sum & CHAIN_MOD) + (sum >> 61);
+    return (sum >= CHAIN_MOD) ? sum - CHAIN_MOD : sum;
+}
+
+// Product of two counts modulo CHAIN_MOD, folding the high bits back in
+// since 2^61 is 1 modulo it.
+uint64_t mulChainMod(uint64_t a, uint64_t b) {
+    unsigned __int128 product = (unsigned __int128)a * b;
+    return addChainMod((uint64_t)(product & CHAIN_MOD), (uint64_t)(product >> 61));
+}
+
+// Count the chains reaching component comp from one side: from a producer
+// going up (its prey components as neighbours) or to an apex predator going
+// down (its predator components). A single organism with no neighbours on
+// that side starts or ends one chain; otherwise it sums its neighbours'.
+// Chains may go round a feeding cycle any number of times, so a cycle that
+// any chain reaches has unboundedly many, and one no chain reaches has none.
+void sumChains(Web* web, int comp, int* nbrs, int numNbrs, uint64_t* mods, long double* ests) {
+    bool cycle = (web -> cond.memberStart[comp + 1] - web -> cond.memberStart[comp] > 1);
+    uint64_t mod = (!cycle && numNbrs == 0);
+    long double est = (long double)mod;
+    for (int k = 0; k < numNbrs; k++) {
+        mod = addChainMod(mod, mods[nbrs[k]]);
+        est += ests[nbrs[k]];
+    }
+    if (cycle) {
+        mod = 0;
+        est = (est > 0.0L) ? (long double)INFINITY : 0.0L;
+    }
+    mods[comp] = mod;
+    ests[comp] = est;
+}
+
+// Group the components by level (counting sort), in components order within
+// a level. Returns the number of levels; levelStart needs numComps + 1 slots.
+int groupByLevel(int* levelOf, int numComps, int* levelStart, int* order) {
+    int numLevels = 0;
+    for (int c = 0; c < numComps; c++) {
+        if (levelOf[c] + 1 > numLevels) {
+            numLevels = levelOf[c] + 1;
+        }
+    }
+    for (int l = 0; l <= numLevels; l++) {
+        levelStart[l] = 0;
+    }
+    for (int c = 0; c < numComps; c++) {
+        levelStart[levelOf[c] + 1]++;
+    }
+    for (int l = 0; l < numLevels; l++) {
+        levelStart[l + 1] += levelStart[l];
+    }
+    for (int c = 0; c < numComps; c++) {
+        order[levelStart[levelOf[c]]++] = c;
+    }
+    for (int l = numLevels; l > 0; l--) {
+        levelStart[l] = levelStart[l - 1];
+    }
+    levelStart[0] = 0;
+    return numLevels;
+}
+
+// Count the food chains from producers to apex predators: for every
+// component, the chains from a producer up to it and from it up to an apex
+// predator (their product is the number through each member), and all of them
+// in total. Isolated species (no prey and no predators) count no chains.
+// Dynamic programming over the condensation: a component's chains
+// from below are the sum over its prey components, so each count costs one
+// step per relation. Components of equal height only depend on lower ones, so
+// each height is one parallel step on large webs, and likewise going down by
+// distance from the apex. Returns false if memory runs out.
+bool countFoodChains(Web* web) {
+    if (!compactWeb(web) || !condenseWeb(web)) {
+        return false;
+    }
+    Condensation* cond = &(web -> cond);
+    ChainCounts* chains = &(web -> chains);
+    int numComps = cond -> numComps;
+    int numDag = cond -> dagStart[numComps];
+    if (!reserveChainCounts(chains, numComps) || !reserveWork(web, 4 * numComps + numDag + 2)) {
+        return false; // Memory allocation failed.
+    }
+
+    // Scratch: the predator components of each component (the condensation
+    // only lists prey), each component's level, and the components by level.
+    int* predStart = web -> work;
+    int* predComps = predStart + numComps + 1;
+    int* levelOf = predComps + numDag;
+    int* levelStart = levelOf + numComps;
+    int* order = levelStart + numComps + 1;
+    predStart[0] = 0;
+    for (int c = 0; c < numComps; c++) {
+        predStart[c + 1] = predStart[c] + cond -> numPred[c];
+        levelOf[c] = predStart[c];
+    }
+    for (int c = 0; c < numComps; c++) {
+        for (int k = cond -> dagStart[c]; k < cond -> dagStart[c + 1]; k++) {
+            predComps[levelOf[cond -> dagPrey[k]]++] = c;
+        }
+    }
+
+    bool parallel = false;
+#ifdef _OPENMP
+    parallel = (web -> numEdges >= PARALLEL_MIN_EDGES && omp_get_max_threads() > 1);
+#endif
+
+    // Going up, one height at a time.
+    int numLevels = groupByLevel(cond -> height, numComps, levelStart, order);
+    for (int l = 0; l < numLevels; l++) {
+        if (parallel && levelStart[l + 1] - levelStart[l] >= PARALLEL_MIN_EDGES / 16) {
+#ifdef _OPENMP
+            #pragma omp parallel for schedule(dynamic, 256)
+            for (int k = levelStart[l]; k < levelStart[l + 1]; k++) {
+                int c = order[k];
+                sumChains(web, c, cond -> dagPrey + cond -> dagStart[c], cond -> dagStart[c + 1] - cond -> dagStart[c],
+                          chains -> upMod, chains -> upEst);
+            }
+#endif
+        } else {
+            for (int k = levelStart[l]; k < levelStart[l + 1]; k++) {
+                int c = order[k];
+                sumChains(web, c, cond -> dagPrey + cond -> dagStart[c], cond -> dagStart[c + 1] - cond -> dagStart[c],
+                          chains -> upMod, chains -> upEst);
+            }
+        }
+    }
+
+    // Going down, by the longest distance to an apex component. Predator
+    // components are numbered higher, so they are final before their prey.
+    for (int c = numComps - 1; c >= 0; c--) {
+        levelOf[c] = 0;
+        for (int k = predStart[c]; k < predStart[c + 1]; k++) {
+            if (levelOf[predComps[k]] + 1 > levelOf[c]) {
+                levelOf[c] = levelOf[predComps[k]] + 1;
+            }
+        }
+    }
+    numLevels = groupByLevel(levelOf, numComps, levelStart, order);
+    for (int l = 0; l < numLevels; l++) {
+        if (parallel && levelStart[l + 1] - levelStart[l] >= PARALLEL_MIN_EDGES / 16) {
+#ifdef _OPENMP
+            #pragma omp parallel for schedule(dynamic, 256)
+            for (int k = levelStart[l]; k < levelStart[l + 1]; k++) {
+                int c = order[k];
+                sumChains(web, c, predComps + predStart[c], predStart[c + 1] - predStart[c],
+                          chains -> downMod, chains -> downEst);
+            }
+#endif
+        } else {
+            for (int k = levelStart[l]; k < levelStart[l + 1]; k++) {
+                int c = order[k];
+                sumChains(web, c, predComps + predStart[c], predStart[c + 1] - predStart[c],
+                          chains -> downMod, chains -> downEst);
+            }
+        }
+    }
+
+    // A species that neither eats nor is eaten is no chain from a producer to
+    // an apex predator, so it counts none (nothing else is linked to it).
+    for (int c = 0; c < numComps; c++) {
+        if (cond -> numPred[c] == 0 && cond -> dagStart[c + 1] == cond -> dagStart[c] &&
+            cond -> memberStart[c + 1] - cond -> memberStart[c] == 1) {
+            chains -> upMod[c] = 0;
+            chains -> upEst[c] = 0.0L;
+            chains -> downMod[c] = 0;
+            chains -> downEst[c] = 0.0L;
+        }
+    }
+
+    // Every chain ends at exactly one apex predator (never inside a cycle,
+    // whose members are all eaten by each other).
+    chains -> totalMod = 0;
+    chains -> totalEst = 0.0L;
+    for (int c = 0; c < numComps; c++) {
+        if (cond -> numPred[c] == 0 && cond -> memberStart[c + 1] - cond -> memberStart[c] == 1) {
+            chains -> totalMod = addChainMod(chains -> totalMod, chains -> upMod[c]);
+            chains -> totalEst += chains -> upEst[c];
+        }
+    }
+    return true;
+}
+
+// Print a chain count: exactly while it is below CHAIN_MOD, otherwise its
+// estimate along with its exact value modulo CHAIN_MOD.
+void printChainCount(uint64_t mod, long double est) {
+    if (isinf(est)) {
+        printf("unbounded (through a feeding cycle)");
+    } else if (est < (long double)CHAIN_MOD) {
+        printf("%llu", (unsigned long long)mod);
+    } else {
+        printf("about %.6Le (%llu modulo 2^61 - 1)", est, (unsigned long long)mod);
+    }
+}
+
+void initDynamics(Dynamics* dyn) {
+    dyn -> biomass = NULL;
+    dyn -> stage = NULL;
+    dyn -> slope = NULL;
+    dyn -> sum = NULL;
+    dyn -> flux = NULL;
+    dyn -> growth = NULL;
+    dyn -> attack = NULL;
+    dyn -> capOrgs = 0;
+}
+
+void freeDynamics(Dynamics* dyn) {
+    free(dyn -> biomass);
+    free(dyn -> stage);
+    free(dyn -> slope);
+    free(dyn -> sum);
+    free(dyn -> flux);
+    free(dyn -> growth);
+    free(dyn -> attack);
+    initDynamics(dyn);
+}
+
+// Set up the dynamics of the web with every organism at biomass 1. Returns
+// false if memory runs out.
+bool startDynamics(Web* web, Dynamics* dyn) {
+    if (!compactWeb(web) || !compactEdges(web)) {
+        return false;
+    }
+    int numOrgs = web -> numOrgs;
+    if (numOrgs > dyn -> capOrgs) {
+        double** arrays[] = {&(dyn -> biomass), &(dyn -> stage), &(dyn -> slope), &(dyn -> sum),
+                             &(dyn -> flux), &(dyn -> growth), &(dyn -> attack)};
+        for (int k = 0; k < 7; k++) {
+            double* newArray = (double*)realloc(*arrays[k], (size_t)numOrgs * sizeof(double));
+            if (newArray == NULL) {
+                return false; // Memory allocation failed.
+            }
+            *arrays[k] = newArray;
+        }
+        dyn -> capOrgs = numOrgs;
+    }
+    for (int i = 0; i < numOrgs; i++) {
+        int numPrey = web -> orgs[i].numPrey;
+        dyn -> biomass[i] = 1.0;
+        dyn -> growth[i] = (numPrey == 0) ? LV_PRODUCER_GROWTH : LV_CONSUMER_GROWTH;
+        dyn -> attack[i] = (numPrey == 0) ? 0.0 : LV_ATTACK / numPrey;
+    }
+    return true;
+}
+
+// Rate of change of one organism at the given state, with dyn -> flux
+// filled in for the same state. Both sums gather over one run of the edge
+// arena.
+double populationSlope(Web* web, Dynamics* dyn, const double* state, int i) {
+    int* prey = preyOf(web, i);
+    double food = 0.0;
+    for (int j = 0; j < web -> orgs[i].numPrey; j++) {
+        food += state[prey[j]];
+    }
+    int* preds = predsOf(web, i);
+    double eaten = 0.0;
+    for (int j = 0; j < web -> links[i].numPred; j++) {
+        eaten += dyn -> flux[preds[j]];
+    }
+    return state[i] * (dyn -> growth[i] - state[i] + LV_EFFICIENCY * dyn -> attack[i] * food - eaten);
+}
+
+// Fill in dyn -> slope at the state in dyn -> stage.
+void populationSlopes(Web* web, Dynamics* dyn, bool parallel) {
+    int numOrgs = web -> numOrgs;
+    double* stage = dyn -> stage;
+    for (int i = 0; i < numOrgs; i++) {
+        dyn -> flux[i] = dyn -> attack[i] * stage[i];
+    }
+    if (parallel) {
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (int i = 0; i < numOrgs; i++) {
+            dyn -> slope[i] = populationSlope(web, dyn, stage, i);
+        }
+#endif
+    } else {
+        for (int i = 0; i < numOrgs; i++) {
+            dyn -> slope[i] = populationSlope(web, dyn, stage, i);
+        }
+    }
+}
+
+// Advance the dynamics by numSteps classic fourth-order Runge-Kutta steps of
+// size step. Organisms whose biomass falls below LV_EXTINCT die out for good.
+// The web must not change while the dynamics run.
+void simulateDynamics(Web* web, Dynamics* dyn, int numSteps, double step) {
+    int numOrgs = web -> numOrgs;
+    double* biomass = dyn -> biomass;
+    double* stage = dyn -> stage;
+    double* slope = dyn -> slope;
+    double* sum = dyn -> sum;
+    bool parallel = false;
+#ifdef _OPENMP
+    parallel = (web -> numEdges >= PARALLEL_MIN_EDGES && omp_get_max_threads() > 1);
+#endif
+
+    // Stage k starts from the biomass plus offsets[k] times the last slope
+    // and adds weights[k] times its own slope to the sum.
+    const double offsets[4] = {0.0, 0.5 * step, 0.5 * step, step};
+    const double weights[4] = {1.0, 2.0, 2.0, 1.0};
+    for (int n = 0; n < numSteps; n++) {
+        for (int i = 0; i < numOrgs; i++) {
+            stage[i] = biomass[i];
+            sum[i] = 0.0;
+        }
+        for (int k = 0; k < 4; k++) {
+            if (k > 0) {
+                for (int i = 0; i < numOrgs; i++) {
+                    stage[i] = biomass[i] + offsets[k] * slope[i];
+                }
+            }
+            populationSlopes(web, dyn, parallel);
+            for (int i = 0; i < numOrgs; i++) {
+                sum[i] += weights[k] * slope[i];
+            }
+        }
+        for (int i = 0; i < numOrgs; i++) {
+            double next = biomass[i] + step / 6.0 * sum[i];
+            biomass[i] = (next < LV_EXTINCT) ? 0.0 : next;
+        }
+    }
+}
+
+// Copy one array out of a mapped snapshot into memory the web owns.
+void* copyOut(const void* data, size_t size, bool* pOk) {
+    if (size == 0) {
+        return NULL;
+    }
+    void* copy = malloc(size);
+    if (copy == NULL) {
+        *pOk = false; // Memory allocation failed.
+        return NULL;
+    }
+    memcpy(copy, data, size);
+    return copy;
+}
+
+// A web loaded from a snapshot points into the read-only mapping. Before it
+// changes, copy its arrays into owned memory so they can grow, release the
+// mapping, and index its relations for duplicate checks.
+bool detachSnapshot(Web* web) {
+    if (web -> snapshot == NULL) {
+        return true;
+    }
+
+    bool ok = true;
+    size_t numOrgs = (size_t)web -> numOrgs;
+    Org* orgs = (Org*)copyOut(web -> orgs, numOrgs * sizeof(Org), &ok);
+    OrgLinks* links = (OrgLinks*)copyOut(web -> links, numOrgs * sizeof(OrgLinks), &ok);
+    int* edges = (int*)copyOut(web -> edges, (size_t)web -> capEdges * sizeof(int), &ok);
+    char* names = (char*)copyOut(web -> names, (size_t)web -> capNames, &ok);
+    NameEntry* nameIndex = (NameEntry*)copyOut(web -> nameIndex, (size_t)web -> capNameIndex * sizeof(NameEntry), &ok);
+    Buckets* bucketSets[] = {&(web -> byNumPred), &(web -> byNumPrey)};
+    int* bucketArrays[6];
+    for (int b = 0; b < 2; b++) {
+        bucketArrays[3 * b] = (int*)copyOut(bucketSets[b] -> heads, (size_t)bucketSets[b] -> capHeads * sizeof(int), &ok);
+        bucketArrays[3 * b + 1] = (int*)copyOut(bucketSets[b] -> prev, numOrgs * sizeof(int), &ok);
+        bucketArrays[3 * b + 2] = (int*)copyOut(bucketSets[b] -> next, numOrgs * sizeof(int), &ok);
+    }
+    if (!ok) {
+        free(orgs);
+        free(links);
+        free(edges);
+        free(names);
+        free(nameIndex);
+        for (int k = 0; k < 6; k++) {
+            free(bucketArrays[k]);
+        }
+        return false;
+    }
+
+    munmap(web -> snapshot, web -> lenSnapshot);
+    web -> snapshot = NULL;
+    web -> lenSnapshot = 0;
+    web -> orgs = orgs;
+    web -> links = links;
+    web -> edges = edges;
+    web -> names = names;
+    web -> nameIndex = nameIndex;
+    for (int b = 0; b < 2; b++) {
+        bucketSets[b] -> heads = bucketArrays[3 * b];
+        bucketSets[b] -> prev = bucketArrays[3 * b + 1];
+        bucketSets[b] -> next = bucketArrays[3 * b + 2];
+    }
+    return rebuildEdgeIndex(web, web -> numEdges);
+}
+
+bool addOrgToWeb(Web* web, char* newOrgName) {
+
+    // A web mapped from a snapshot is copied out before it changes.
+    if (!detachSnapshot(web)) {
+        return false;
+    }
+    web -> version++;
+
+    // When the array is full and at least half of it is tombstones, reclaim
+    // those slots instead of growing. This renumbers the organisms.
+    if (web -> numOrgs == web -> capOrgs && 2 * web -> numExtinct >= web -> numOrgs) {
+        if (!compactWeb(web)) {
+            return false;
+        }
+    }
+
+    // Make room for one more organism (only reallocates when the array is full).
+    if (!reserveOrgs(web, web -> numOrgs + 1) ||
+        !reserveBuckets(&(web -> byNumPred), 0) || !reserveBuckets(&(web -> byNumPrey), 0)) {
+        return false;
+    }
+
+    // Intern the name so it is stored once and can be looked up in O(1).
+    NameEntry* entry = internName(web, newOrgName);
+    if (entry == NULL) {
+        return false;
+    }
+    entry -> refs++;
+    if (entry -> orgInd == -1) {
+        entry -> orgInd = web -> numOrgs;
+    }
+
+    // Append the new organism at the end with an empty prey run.
+    // Zero it first so no stale padding bytes end up in a snapshot.
+    Org* org = &(web -> orgs[web -> numOrgs]);
+    memset(org, 0, sizeof(Org));
+    org -> nameOff = entry -> nameOff;
+    org -> preyStart = web -> endEdges;
+    org -> numPrey = 0;
+    org -> preyCap = 0;
+    org -> extinct = false;
+
+    // It has no predators yet: an apex predator, a producer, and height 0.
+    OrgLinks* link = &(web -> links[web -> numOrgs]);
+    link -> predStart = web -> endEdges;
+    link -> numPred = 0;
+    link -> predCap = 0;
+    link -> numProducerPrey = 0;
+    link -> height = 0;
+    linkBucket(&(web -> byNumPred), web -> numOrgs, 0);
+    linkBucket(&(web -> byNumPrey), web -> numOrgs, 0);
+
+    // Update the number of organisms.
+    web -> numOrgs++;
+    appendToLiveTree(web);
+    return true;
+}
+
+bool addRelationToWeb(Web* web, int predInd, int preyInd) {
+
+    // Check if indices are valid.
+    int numOrgs = web -> numOrgs;
+    if (predInd < 0 || predInd >= numOrgs || preyInd < 0  || preyInd >= numOrgs || predInd == preyInd ||
+        web -> orgs[predInd].extinct || web -> orgs[preyInd].extinct) {
+        printf("Invalid predator and/or prey index. No relation added to the food web.\n");
+        return false;
+    }
+
+    // Check for duplicate relation (expected O(1) through the edge hash set).
+    // A rejected duplicate leaves the web, its version and any mapping alone.
+    if (hasRelation(web, predInd, preyInd)) {
+        printf("Duplicate predator/prey relation. No relation added to the food web.\n");
+        return false;
+    }
+
+    // A web mapped from a snapshot is copied out before it changes.
+    if (!detachSnapshot(web)) {
+        return false;
+    }
+    web -> version++;
+    Org* predator = &(web -> orgs[predInd]);
+
+    // Grow the hash set before it passes half full.
+    if (2 * (web -> numEdgeKeys + 1) > web -> capEdgeKeys) {
+        if (!rebuildEdgeIndex(web, web -> numEdges + 1)) {
+            return false; // memory allocation failed
+        }
+    }
+
+    // Reclaim the arena's garbage once it outweighs the live relations.
+    if (web -> freedEdges > 64 && web -> freedEdges > 2 * web -> numEdges) {
+        if (!compactEdges(web)) {
+            return false; // memory allocation failed
+        }
+    }
+
+    // Make room in the predator's prey run and the prey's predator run
+    // (amortized O(1), no per-edge malloc).
+    OrgLinks* preyLink = &(web -> links[preyInd]);
+    if (predator -> numPrey == predator -> preyCap) {
+        if (!growRun(web, &(predator -> preyStart), &(predator -> preyCap), predator -> numPrey)) {
+            return false; // memory allocation failed
+        }
+    }
+    if (preyLink -> numPred == preyLink -> predCap) {
+        if (!growRun(web, &(preyLink -> predStart), &(preyLink -> predCap), preyLink -> numPred)) {
+            return false; // memory allocation failed
+        }
+    }
+    if (!reserveBuckets(&(web -> byNumPred), preyLink -> numPred + 1) ||
+        !reserveBuckets(&(web -> byNumPrey), predator -> numPrey + 1)) {
+        return false; // memory allocation failed
+    }
+    bool predWasProducer = (predator -> numPrey == 0);
+    bool preyIsProducer = (web -> orgs[preyInd].numPrey == 0);
+
+    // The predator moves up one out-degree bucket.
+    preyOf(web, predInd)[predator -> numPrey] = preyInd;
+    predator -> numPrey++;
+    web -> numEdges++;
+    insertEdgeKey(web, edgeKey(predInd, preyInd));
+    moveBucket(&(web -> byNumPrey), predInd, predator -> numPrey - 1, predator -> numPrey);
+
+    // The prey moves up one in-degree bucket.
+    predsOf(web, preyInd)[preyLink -> numPred] = predInd;
+    preyLink -> numPred++;
+    moveBucket(&(web -> byNumPred), preyInd, preyLink -> numPred - 1, preyLink -> numPred);
+
+    // Reclassify vore types: the predator may gain a producer prey, and if it
+    // was a producer itself, its own predators just lost one.
+    if (preyIsProducer) {
+        web -> links[predInd].numProducerPrey++;
+    }
+    if (predWasProducer) {
+        int* preds = predsOf(web, predInd);
+        for (int i = 0; i < web -> links[predInd].numPred; i++) {
+            web -> links[preds[i]].numProducerPrey--;
+        }
+    }
+
+    // Heights can only grow along the predator's ancestors.
+    updateHeights(web, &predInd, 1);
+    return true;
+}
+
+// Release an extinct organism's name, handing it over to the next organism
+// sharing it.
+void releaseName(Web* web, int index) {
+    char* name = orgName(web, index);
+    NameEntry* entry = &(web -> nameIndex[findNameSlot(web, name, nameHash(name))]);
+    entry -> refs--;
+    if (entry -> orgInd == index) {
+        entry -> orgInd = -1;
+        for (int i = index + 1; entry -> refs > 0 && i < web -> numOrgs; i++) {
+            if (web -> orgs[i].nameOff == web -> orgs[index].nameOff && !web -> orgs[i].extinct) {
+                entry -> orgInd = i;
+                break;
+            }
+        }
+    }
+}
+
+bool removeOrgFromWeb(Web* web, int index) {
+
+    // Check if the index is valid.
+    if (index < 0 || index >= web -> numOrgs || web -> orgs[index].extinct) {
+        printf("Invalid extinction index. No organism removed from the food web.\n");
+        return false;
+    }
+    if (!detachSnapshot(web)) {
+        return false; // A web mapped from a snapshot is copied out before it changes.
+    }
+    web -> version++;
+
+    // Mark a tombstone. The slot keeps its index until compactWeb() renumbers
+    // the organisms, so no other organism has to move.
+    Org* org = &(web -> orgs[index]);
+    OrgLinks* link = &(web -> links[index]);
+    org -> extinct = true;
+    web -> numExtinct++;
+    dropFromLiveTree(web, index);
+    unlinkBucket(&(web -> byNumPred), index, link -> numPred);
+    unlinkBucket(&(web -> byNumPrey), index, org -> numPrey);
+    bool wasProducer = (org -> numPrey == 0);
+
+    // Detach it from its prey's predator runs; each prey drops one in-degree bucket.
+    int* prey = preyOf(web, index);
+    for (int i = 0; i < org -> numPrey; i++) {
+        OrgLinks* preyLink = &(web -> links[prey[i]]);
+        int* predsOfPrey = predsOf(web, prey[i]);
+        for (int j = 0; j < preyLink -> numPred; j++) {
+            if (predsOfPrey[j] == index) {
+                predsOfPrey[j] = predsOfPrey[--(preyLink -> numPred)];
+                break;
+            }
+        }
+        moveBucket(&(web -> byNumPred), prey[i], preyLink -> numPred + 1, preyLink -> numPred);
+        web -> numEdges--;
+    }
+
+    // Detach it from its predators' prey runs, keeping their order. The
+    // reverse adjacency finds them without scanning the whole web, and only
+    // these predators (and theirs, if one becomes a producer) change vore type.
+    int* preds = predsOf(web, index);
+    for (int i = 0; i < link -> numPred; i++) {
+        int predInd = preds[i];
+        Org* predator = &(web -> orgs[predInd]);
+        int* predPrey = preyOf(web, predInd);
+        int k = 0;
+        for (int j = 0; j < predator -> numPrey; j++) {
+            if (predPrey[j] != index) {
+                predPrey[k++] = predPrey[j];
+            }
+        }
+        predator -> numPrey = k;
+        moveBucket(&(web -> byNumPrey), predInd, k + 1, k);
+        web -> numEdges--;
+
+        if (wasProducer) {
+            web -> links[predInd].numProducerPrey--;
+        }
+        if (k == 0) {
+            int* predPreds = predsOf(web, predInd);
+            for (int j = 0; j < web -> links[predInd].numPred; j++) {
+                web -> links[predPreds[j]].numProducerPrey++;
+            }
+        }
+    }
+
+    // Only its ancestors' heights can drop, starting with its predators.
+    updateHeights(web, predsOf(web, index), link -> numPred);
+
+    // Both of its runs become garbage in the arena.
+    web -> freedEdges += org -> preyCap + link -> predCap;
+    org -> numPrey = 0;
+    org -> preyCap = 0;
+    link -> numPred = 0;
+    link -> predCap = 0;
+
+    releaseName(web, index);
+    return true;
+}
+
+// Map a whole file into memory for reading. Falls back to reading it into a
+// heap buffer where mapping is not possible (e.g. an empty file or a pipe).
+bool mapFile(const char* path, char** pData, size_t* pSize, bool* pMapped) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void* data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            madvise(data, (size_t)info.st_size, MADV_SEQUENTIAL);
+            close(fd);
+            *pData = (char*)data;
+            *pSize = (size_t)info.st_size;
+            *pMapped = true;
+            return true;
+        }
+    }
+
+    // Read it in chunks, growing the buffer geometrically.
+    size_t size = 0;
+    size_t cap = 4096;
+    char* data = (char*)malloc(cap);
+    ssize_t got = 0;
+    while (data != NULL && (got = read(fd, data + size, cap - size)) > 0) {
+        size += (size_t)got;
+        if (size == cap) {
+            char* newData = (char*)realloc(data, 2 * cap);
+            if (newData == NULL) {
+                free(data); // Memory allocation failed.
+            }
+            data = newData;
+            cap *= 2;
+        }
+    }
+    close(fd);
+    if (data == NULL || got < 0) {
+        free(data);
+        return false;
+    }
+    *pData = data;
+    *pSize = size;
+    *pMapped = false;
+    return true;
+}
+
+void unmapFile(char* data, size_t size, bool mapped) {
+    if (mapped) {
+        munmap(data, size);
+    } else {
+        free(data);
+    }
+}
+
+// Resolve a batch of names to organisms, adding an organism the first time
+// its name is seen (or resolving it to -1 unless addMissing), and append a
+// (predator, prey) pair for every name after the first on a line. *pPredInd
+// carries the line's predator across batches.
+bool importNames(Web* web, ImportBatch* batch, bool addMissing, int* pPredInd, char** pName, int* pCapName,
+                 int** pPairs, int* pNumPairs, int* pCapPairs) {
+#if defined(__GNUC__)
+    if (web -> capNameIndex > 0) {
+        for (int k = 0; k < batch -> numNames; k++) {
+            __builtin_prefetch(&(web -> nameIndex[batch -> hashes[k] & (uint32_t)(web -> capNameIndex - 1)]));
+        }
+    }
+#endif
+
+    for (int k = 0; k < batch -> numNames; k++) {
+        // Copy the name out of the (read-only) mapping.
+        int len = batch -> lens[k];
+        if (len + 1 > *pCapName) {
+            int newCap = (*pCapName > 0) ? *pCapName : 32;
+            while (newCap < len + 1) {
+                newCap *= 2;
+            }
+            char* newName = (char*)realloc(*pName, newCap);
+            if (newName == NULL) {
+                return false; // Memory allocation failed.
+            }
+            *pName = newName;
+            *pCapName = newCap;
+        }
+        memcpy(*pName, batch -> starts[k], len);
+        (*pName)[len] = '\0';
+
+        int orgInd = -1;
+        if (web -> capNameIndex > 0) {
+            NameEntry* entry = &(web -> nameIndex[findNameSlot(web, *pName, batch -> hashes[k])]);
+            orgInd = (entry -> nameOff == -1) ? -1 : entry -> orgInd;
+        }
+        if (orgInd == -1 && addMissing) {
+            if (!addOrgToWeb(web, *pName)) {
+                return false;
+            }
+            orgInd = web -> numOrgs - 1;
+        }
+        if (batch -> firsts[k]) {
+            *pPredInd = orgInd; // The first name on a line is the predator.
+            continue;
+        }
+
+        if (2 * (*pNumPairs + 1) > *pCapPairs) {
+            int newCap = (*pCapPairs > 0) ? 2 * *pCapPairs : 1024;
+            int* newPairs = (int*)realloc(*pPairs, newCap * sizeof(int));
+            if (newPairs == NULL) {
+                return false; // Memory allocation failed.
+            }
+            *pPairs = newPairs;
+            *pCapPairs = newCap;
+        }
+        (*pPairs)[2 * *pNumPairs] = *pPredInd;
+        (*pPairs)[2 * *pNumPairs + 1] = orgInd;
+        (*pNumPairs)++;
+    }
+    batch -> numNames = 0;
+    return true;
+}
+
+// Parse an edge-list or CSV file in a single pass over the mapped file. Each
+// line names a predator followed by its prey, separated by whitespace or
+// commas ("Hawk,Mouse", "Hawk Mouse Snake"), and '#' starts a comment. Names
+// are matched against the web (and earlier lines) through the name index;
+// unknown names add organisms if addMissing is set and resolve to -1
+// otherwise. *pPairs receives the (predator, prey) pairs in file order, to be
+// freed by the caller. Returns false if the file cannot be read or memory
+// runs out.
+bool readPairs(Web* web, const char* path, bool addMissing, int** pPairs, int* pNumPairs) {
+    char* data;
+    size_t size;
+    bool mapped;
+    if (!mapFile(path, &data, &size, &mapped)) {
+        return false;
+    }
+
+    bool ok = true;
+    char* name = NULL; // Growable buffer for the name being parsed.
+    int capName = 0;
+    int* pairs = NULL; // (predator, prey) pairs in file order.
+    int numPairs = 0;
+    int capPairs = 0;
+
+    ImportBatch batch;
+    batch.numNames = 0;
+    int predInd = -1;
+    size_t pos = 0;
+    while (ok && pos < size) {
+        bool first = true;
+        while (pos < size && data[pos] != '\n') {
+            // Skip separators; a comment runs to the end of the line.
+            char c = data[pos];
+            if (c == ' ' || c == '\t' || c == '\r' || c == ',') {
+                pos++;
+                continue;
+            }
+            if (c == '#') {
+                while (pos < size && data[pos] != '\n') {
+                    pos++;
+                }
+                break;
+            }
+
+            // Scan the name, hashing it on the way (same as nameHash()).
+            size_t start = pos;
+            uint32_t hash = 2166136261u;
+            while (pos < size && !isspace((unsigned char)data[pos]) && data[pos] != ',' && data[pos] != '#') {
+                hash = (hash ^ (unsigned char)data[pos]) * 16777619u;
+                pos++;
+            }
+            int k = batch.numNames++;
+            batch.starts[k] = data + start;
+            batch.lens[k] = (int)(pos - start);
+            batch.hashes[k] = hash;
+            batch.firsts[k] = first;
+            first = false;
+            if (batch.numNames == IMPORT_BATCH &&
+                !importNames(web, &batch, addMissing, &predInd, &name, &capName, &pairs, &numPairs, &capPairs)) {
+                ok = false;
+                break;
+            }
+        }
+        pos++; // Past the newline.
+    }
+    if (ok) {
+        ok = importNames(web, &batch, addMissing, &predInd, &name, &capName, &pairs, &numPairs, &capPairs);
+    }
+    unmapFile(data, size, mapped);
+    free(name);
+    if (!ok) {
+        free(pairs);
+        return false;
+    }
+    *pPairs = pairs;
+    *pNumPairs = numPairs;
+    return true;
+}
+
+// Load organisms and relations from an edge-list or CSV file (see
+// readPairs()); a line with one name only adds that organism. The relations
+// are collected first and then laid out in one go: duplicates and
+// self-relations are dropped through the edge hash set, each predator's prey
+// run is filled in file order, and the predator runs, degree buckets and vore
+// counts are rebuilt once. Heights are left for the next
+// display to recompute. Returns false if the file cannot be read or memory
+// runs out; pNumSkipped receives the number of relations dropped.
+bool importWeb(Web* web, const char* path, int* pNumSkipped) {
+
+    // Organisms are appended by index below, so close any gaps first.
+    bool ok = detachSnapshot(web) && compactWeb(web);
+    web -> version++;
+    int* pairs = NULL; // (predator, prey) pairs in file order.
+    int numPairs = 0;
+    ok = ok && readPairs(web, path, true, &pairs, &numPairs);
+
+    int numOrgs = web -> numOrgs;
+    int* newPrey = NULL;
+    if (ok) {
+        ok = rebuildEdgeIndex(web, web -> numEdges + numPairs) && reserveWork(web, numOrgs + 1);
+    }
+    if (ok) {
+        ok = reserveSpare(web, web -> numEdges + numPairs);
+        newPrey = web -> spare;
+    }
+
+    // Drop duplicate and self-relations, counting the rest per predator.
+    int numSkipped = 0;
+    int numNew = 0;
+    if (ok) {
+        int* counts = web -> work;
+        for (int i = 0; i < numOrgs; i++) {
+            counts[i] = 0;
+        }
+        for (int k = 0; k < numPairs; k++) {
+            int predInd = pairs[2 * k];
+            int preyInd = pairs[2 * k + 1];
+            if (predInd == preyInd || hasRelation(web, predInd, preyInd)) {
+                pairs[2 * k] = -1;
+                numSkipped++;
+                continue;
+            }
+            insertEdgeKey(web, edgeKey(predInd, preyInd));
+            counts[predInd]++;
+            numNew++;
+        }
+
+        // Lay out the prey runs: each organism's existing prey, then its new
+        // prey in file order. counts[] becomes each run's next free slot.
+        int offset = 0;
+        for (int i = 0; i < numOrgs; i++) {
+            Org* org = &(web -> orgs[i]);
+            if (org -> numPrey > 0) {
+                memcpy(newPrey + offset, preyOf(web, i), org -> numPrey * sizeof(int));
+            }
+            int numAdded = counts[i];
+            counts[i] = offset + org -> numPrey;
+            org -> preyStart = offset;
+            org -> numPrey += numAdded;
+            offset += org -> numPrey;
+        }
+        for (int k = 0; k < numPairs; k++) {
+            if (pairs[2 * k] != -1) {
+                newPrey[counts[pairs[2 * k]]++] = pairs[2 * k + 1];
+            }
+        }
+
+        // Build the predator runs and everything derived from them around
+        // the new prey runs.
+        swapSpare(web, offset);
+        web -> numEdges += numNew;
+        ok = rebuildLinks(web);
+        web -> heightsValid = false;
+    }
+    free(pairs);
+    *pNumSkipped = numSkipped;
+    return ok;
+}
+
+
+// Answer "does X ultimately eat Y" for every pair in a query file laid out
+// like an import file (see readPairs()), printing one line per pair and
+// skipping pairs that name an unknown organism. pNumUnknown receives the
+// number skipped. Returns false if the file cannot be read or memory runs out.
+bool answerQueryFile(Web* web, const char* path, int* pNumUnknown) {
+    int* pairs = NULL; // (predator, prey) pairs in file order.
+    int numPairs = 0;
+    if (!compactWeb(web) || !readPairs(web, path, false, &pairs, &numPairs)) {
+        return false;
+    }
+    int numKnown = 0;
+    for (int k = 0; k < numPairs; k++) {
+        if (pairs[2 * k] != -1 && pairs[2 * k + 1] != -1) {
+            pairs[2 * numKnown] = pairs[2 * k];
+            pairs[2 * numKnown + 1] = pairs[2 * k + 1];
+            numKnown++;
+        }
+    }
+    char* answers = (char*)malloc(numKnown + 1);
+    bool ok = (answers != NULL) && queryReachBatch(web, pairs, numKnown, answers);
+    for (int k = 0; ok && k < numKnown; k++) {
+        printf("  %s ultimately eats %s: %s\n", orgName(web, pairs[2 * k]), orgName(web, pairs[2 * k + 1]),
+               answers[k] ? "yes" : "no");
+    }
+    free(answers);
+    free(pairs);
+    *pNumUnknown = numPairs - numKnown;
+    return ok;
+}
+
+// Next value of a xorshift64* generator, so that a generated web is the same
+// on every platform for the same seed.
+uint64_t nextRandom(uint64_t* pState) {
+    uint64_t x = *pState;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *pState = x;
+    return x * 2685821657736338717ull;
+}
+
+// A uniform random number in [0, 1).
+double randomUnit(uint64_t* pState) {
+    return (double)(nextRandom(pState) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+int compareDoubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Add a synthetic food web of model -> numSpecies organisms ("s0", "s1", ...)
+// with an expected connectance (relations per species squared) of
+// model -> connectance, through the same calls as a web typed in by hand.
+// Cascade model: species are ranked, and each one eats each lower-ranked
+// species independently with the probability giving that connectance; runs of
+// missed prey are skipped geometrically, so this takes time in the number of
+// relations rather than species squared. Niche model: each species gets a
+// niche value and eats every species whose value falls in a feeding range
+// below its own (a Beta(1, b) fraction of its value, b = 1 / (2C) - 1), which
+// allows feeding cycles; species are added in niche order, so each range is
+// found by binary search. Returns false if memory runs out.
+bool generateWeb(Web* web, WebModel* model, uint64_t seed) {
+    int numSpecies = model -> numSpecies;
+    double connectance = model -> connectance;
+    uint64_t state = seed | 1; // xorshift never leaves zero.
+    int firstInd = web -> numOrgs;
+    char name[16];
+    for (int i = 0; i < numSpecies; i++) {
+        sprintf(name, "s%d", i);
+        if (!addOrgToWeb(web, name)) {
+            return false;
+        }
+    }
+
+    if (model -> kind == 'c') {
+        double p = (numSpecies > 1) ? 2.0 * connectance * numSpecies / (numSpecies - 1) : 0.0;
+        if (p <= 0.0) {
+            return true;
+        }
+        double logMiss = (p < 1.0) ? log(1.0 - p) : 0.0;
+        for (int predInd = 1; predInd < numSpecies; predInd++) {
+            double preyInd = -1.0;
+            while (true) {
+                preyInd += (p < 1.0) ? 1.0 + floor(log(1.0 - randomUnit(&state)) / logMiss) : 1.0;
+                if (preyInd >= predInd) {
+                    break;
+                }
+                if (!addRelationToWeb(web, firstInd + predInd, firstInd + (int)preyInd)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Niche model.
+    double* niches = (double*)malloc((numSpecies + 1) * sizeof(double));
+    if (niches == NULL) {
+        return false; // Memory allocation failed.
+    }
+    for (int i = 0; i < numSpecies; i++) {
+        niches[i] = randomUnit(&state);
+    }
+    qsort(niches, numSpecies, sizeof(double), compareDoubles);
+    double beta = 1.0 / (2.0 * connectance) - 1.0;
+    bool ok = true;
+    for (int predInd = 1; predInd < numSpecies && ok; predInd++) { // The lowest niche is a producer.
+        double range = niches[predInd] * (1.0 - pow(1.0 - randomUnit(&state), 1.0 / beta));
+        double center = range / 2.0 + randomUnit(&state) * (niches[predInd] - range / 2.0);
+        double lowest = center - range / 2.0;
+        int lo = 0;
+        int hi = numSpecies;
+        while (lo < hi) { // First species at or above the range.
+            int mid = lo + (hi - lo) / 2;
+            if (niches[mid] < lowest) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        for (int preyInd = lo; preyInd < numSpecies && niches[preyInd] <= center + range / 2.0 && ok; preyInd++) {
+            if (preyInd != predInd) {
+                ok = addRelationToWeb(web, firstInd + predInd, firstInd + preyInd);
+            }
+        }
+    }
+    free(niches);
+    return ok;
+}
+
+void initBatch(WebBatch* batch) {
+    batch -> ops = NULL;
+    batch -> numOps = 0;
+    batch -> capOps = 0;
+    batch -> names = NULL;
+    batch -> lenNames = 0;
+    batch -> capNames = 0;
+}
+
+void freeBatch(WebBatch* batch) {
+    free(batch -> ops);
+    free(batch -> names);
+    initBatch(batch);
+}
+
+// Copy a name into the batch's name pool and return its offset, or -1 on
+// allocation failure.
+int addNameToBatch(WebBatch* batch, const char* name) {
+    int len = (int)strlen(name) + 1;
+    if (batch -> lenNames + len > batch -> capNames) {
+        int newCap = (batch -> capNames > 0) ? batch -> capNames : 256;
+        while (newCap < batch -> lenNames + len) {
+            newCap *= 2;
+        }
+        char* newNames = (char*)realloc(batch -> names, newCap);
+        if (newNames == NULL) {
+            return -1; // Memory allocation failed.
+        }
+        batch -> names = newNames;
+        batch -> capNames = newCap;
+    }
+    memcpy(batch -> names + batch -> lenNames, name, len);
+    batch -> lenNames += len;
+    return batch -> lenNames - len;
+}
+
+// Queue one modification. For 'o', 'R' and 'X' the arguments are name
+// offsets from addNameToBatch(); for 'r' and 'x' they are organism indices.
+bool addOpToBatch(WebBatch* batch, char kind, int arg0, int arg1) {
+    if (batch -> numOps == batch -> capOps) {
+        int newCap = (batch -> capOps > 0) ? 2 * batch -> capOps : 16;
+        WebOp* newOps = (WebOp*)realloc(batch -> ops, newCap * sizeof(WebOp));
+        if (newOps == NULL) {
+            return false; // Memory allocation failed.
+        }
+        batch -> ops = newOps;
+        batch -> capOps = newCap;
+    }
+    WebOp* op = &(batch -> ops[batch -> numOps++]);
+    op -> kind = kind;
+    op -> args[0] = arg0;
+    op -> args[1] = arg1;
+    return true;
+}
+
+// Apply a batch of modifications as one transaction. Indices refer to the
+// web as printed when the batch starts, followed by the batch's new
+// organisms in order; extinct organisms keep their index until the batch
+// ends. Each operation is checked in order like its menu command (invalid
+// ones are reported and skipped), but the work is deferred: the organism
+// array and edge index are sized once up front, and the relations are laid
+// out, the reverse adjacency, degree buckets and vore counts rebuilt, the
+// web compacted and the heights recomputed once at the end.
+// Returns false on allocation failure; pNumRejected receives the number of
+// operations skipped.
+bool applyBatch(Web* web, WebBatch* batch, int* pNumRejected) {
+    if (!detachSnapshot(web) || !compactWeb(web)) {
+        return false;
+    }
+    web -> version++;
+
+    // Size the organism array and the edge index for the whole batch.
+    int numNewOrgs = 0;
+    int numNewRels = 0;
+    for (int k = 0; k < batch -> numOps; k++) {
+        char kind = batch -> ops[k].kind;
+        numNewOrgs += (kind == 'o');
+        numNewRels += (kind == 'r' || kind == 'R');
+    }
+    if (!reserveOrgs(web, web -> numOrgs + numNewOrgs)) {
+        return false;
+    }
+    if (2 * (web -> numEdgeKeys + numNewRels) > web -> capEdgeKeys &&
+        !rebuildEdgeIndex(web, web -> numEdges + numNewRels)) {
+        return false;
+    }
+    int* pairs = NULL; // (predator, prey) pairs in batch order
+    if (numNewRels > 0) {
+        pairs = (int*)malloc(2 * numNewRels * sizeof(int));
+        if (pairs == NULL) {
+            return false; // Memory allocation failed.
+        }
+    }
+
+    // Check and record each operation in order.
+    int numPairs = 0;
+    int numRejected = 0;
+    for (int k = 0; k < batch -> numOps; k++) {
+        WebOp* op = &(batch -> ops[k]);
+        if (op -> kind == 'o') {
+            if (!addOrgToWeb(web, batch -> names + op -> args[0])) {
+                free(pairs);
+                return false;
+            }
+        } else if (op -> kind == 'r' || op -> kind == 'R') {
+            int predInd = op -> args[0];
+            int preyInd = op -> args[1];
+            if (op -> kind == 'R') {
+                predInd = findOrgByName(web, batch -> names + op -> args[0]);
+                preyInd = findOrgByName(web, batch -> names + op -> args[1]);
+            }
+            if (predInd < 0 || predInd >= web -> numOrgs || preyInd < 0 || preyInd >= web -> numOrgs ||
+                predInd == preyInd || web -> orgs[predInd].extinct || web -> orgs[preyInd].extinct) {
+                printf("Invalid predator and/or prey index. No relation added to the food web.\n");
+                numRejected++;
+            } else if (hasRelation(web, predInd, preyInd)) {
+                printf("Duplicate predator/prey relation. No relation added to the food web.\n");
+                numRejected++;
+            } else {
+                insertEdgeKey(web, edgeKey(predInd, preyInd));
+                pairs[2 * numPairs] = predInd;
+                pairs[2 * numPairs + 1] = preyInd;
+                numPairs++;
+            }
+        } else if (op -> kind == 'x' || op -> kind == 'X') {
+            int index = op -> args[0];
+            if (op -> kind == 'X') {
+                index = findOrgByName(web, batch -> names + op -> args[0]);
+            }
+            if (index < 0 || index >= web -> numOrgs || web -> orgs[index].extinct) {
+                printf("Invalid extinction index. No organism removed from the food web.\n");
+                numRejected++;
+            } else {
+                // Tombstone it now; its relations are dropped in the layout below.
+                web -> orgs[index].extinct = true;
+                web -> numExtinct++;
+                dropFromLiveTree(web, index);
+                releaseName(web, index);
+            }
+        }
+    }
+    *pNumRejected = numRejected;
+
+    // Count every survivor's relations: its live prey, then its new prey.
+    int numOrgs = web -> numOrgs;
+    if (!reserveWork(web, numOrgs)) {
+        free(pairs);
+        return false;
+    }
+    int* counts = web -> work;
+    for (int i = 0; i < numOrgs; i++) {
+        counts[i] = 0;
+    }
+    for (int k = 0; k < numPairs; k++) {
+        if (web -> orgs[pairs[2 * k]].extinct || web -> orgs[pairs[2 * k + 1]].extinct) {
+            pairs[2 * k] = -1; // One side went extinct later in the batch.
+        } else {
+            counts[pairs[2 * k]]++;
+        }
+    }
+    int numEdges = 0;
+    for (int i = 0; i < numOrgs; i++) {
+        if (web -> orgs[i].extinct) {
+            continue;
+        }
+        int* prey = preyOf(web, i);
+        for (int j = 0; j < web -> orgs[i].numPrey; j++) {
+            numEdges += !web -> orgs[prey[j]].extinct;
+        }
+        numEdges += counts[i];
+    }
+
+    // One layout pass into a fresh run of prey indices; counts[] becomes
+    // each run's next free slot for the new prey.
+    if (!reserveSpare(web, numEdges)) {
+        free(pairs);
+        return false; // Memory allocation failed.
+    }
+    int* newPrey = web -> spare;
+    int offset = 0;
+    for (int i = 0; i < numOrgs; i++) {
+        Org* org = &(web -> orgs[i]);
+        int* prey = preyOf(web, i);
+        int start = offset;
+        for (int j = 0; !org -> extinct && j < org -> numPrey; j++) {
+            if (!web -> orgs[prey[j]].extinct) {
+                newPrey[offset++] = prey[j];
+            }
+        }
+        int numKept = offset - start;
+        org -> preyStart = start;
+        org -> numPrey = numKept + counts[i];
+        counts[i] = offset; // The new prey follow the kept ones.
+        offset += org -> numPrey - numKept;
+    }
+    for (int k = 0; k < numPairs; k++) {
+        if (pairs[2 * k] != -1) {
+            newPrey[counts[pairs[2 * k]]++] = pairs[2 * k + 1];
+        }
+    }
+    free(pairs);
+    swapSpare(web, offset);
+    web -> numEdges = numEdges;
+
+    // Rebuild everything derived from the relations once: compaction
+    // renumbers and rebuilds the links and edge index when the batch made
+    // anything extinct, otherwise the links alone need rebuilding.
+    bool ok = (web -> numExtinct > 0) ? compactWeb(web) : rebuildLinks(web);
+    return ok && recomputeHeights(web);
+}
+
+void freeWeb(Web* web) {
+
+    // Arrays that point into a mapped snapshot go away with the mapping.
+    if (web -> snapshot != NULL) {
+        munmap(web -> snapshot, web -> lenSnapshot);
+        web -> orgs = NULL;
+        web -> links = NULL;
+        web -> edges = NULL;
+        web -> names = NULL;
+        web -> nameIndex = NULL;
+        initBuckets(&(web -> byNumPred));
+        initBuckets(&(web -> byNumPrey));
+    }
 
-        // Allocate new memory for the updated food web.
-        Org* newWeb = (Org*)malloc(newCount * sizeof(Org));
+    // Free the name pool and index, the edge index, the edge arena, the
+    // derived characteristics and the web arrays themselves.
+    free(web -> names);
+    free(web -> nameIndex);
+    free(web -> edgeKeys);
+    free(web -> edges);
+    free(web -> spare);
+    free(web -> work);
+    freeCondensation(&(web -> cond));
+    free(web -> levels);
+    free(web -> nextLevels);
+    freeReachIndex(&(web -> reach));
+    freeChainCounts(&(web -> chains));
+    freeBuckets(&(web -> byNumPred));
+    freeBuckets(&(web -> byNumPrey));
+    free(web -> links);
+    free(web -> liveTree);
+    free(web -> orgs);
+    initWeb(web);
+}
 
-        // Copy all existing organisms to the new allocation.
-        for (int i = 0; i < oldCount; i++) {
-            newWeb[i] = (*pWeb)[i];
+// Empty the web for another one, keeping every buffer it has grown, so that a
+// web reused for many in turn stops allocating once it has held the largest.
+void clearWeb(Web* web) {
+    if (web -> snapshot != NULL) {
+        freeWeb(web); // Nothing of a mapped snapshot can be reused.
+        return;
+    }
+    web -> numOrgs = 0;
+    web -> numExtinct = 0;
+    web -> liveTreeValid = false;
+    Buckets* bucketSets[] = {&(web -> byNumPred), &(web -> byNumPrey)};
+    for (int b = 0; b < 2; b++) {
+        for (int d = 0; d < bucketSets[b] -> capHeads; d++) {
+            bucketSets[b] -> heads[d] = -1;
         }
+        bucketSets[b] -> maxDeg = 0;
+    }
+    web -> heightsValid = true;
+    web -> version++;
+    web -> endEdges = 0;
+    web -> numEdges = 0;
+    web -> freedEdges = 0;
+    if (web -> capEdgeKeys > 0) {
+        memset(web -> edgeKeys, 0, (size_t)web -> capEdgeKeys * sizeof(uint64_t));
+    }
+    web -> numEdgeKeys = 0;
+    web -> lenNames = 0;
+    for (int i = 0; i < web -> capNameIndex; i++) {
+        emptyNameEntry(&(web -> nameIndex[i]));
+    }
+    web -> numNames = 0;
+}
+
+// Fill in the section offsets and sizes of a snapshot of the web.
+void layoutSnapshot(Web* web, SnapshotHeader* header) {
+    uint64_t numOrgs = (uint64_t)web -> numOrgs;
+    uint64_t sizes[NUM_SNAPSHOT_SECTIONS] = {
+        numOrgs * sizeof(Org),
+        numOrgs * sizeof(OrgLinks),
+        2 * (uint64_t)web -> numEdges * sizeof(int),
+        (uint64_t)web -> lenNames,
+        (uint64_t)web -> capNameIndex * sizeof(NameEntry),
+        (uint64_t)web -> byNumPred.capHeads * sizeof(int),
+        numOrgs * sizeof(int),
+        numOrgs * sizeof(int),
+        (uint64_t)web -> byNumPrey.capHeads * sizeof(int),
+        numOrgs * sizeof(int),
+        numOrgs * sizeof(int)
+    };
+    uint64_t offset = (sizeof(SnapshotHeader) + 7) & ~(uint64_t)7;
+    for (int i = 0; i < NUM_SNAPSHOT_SECTIONS; i++) {
+        header -> offsets[i] = offset;
+        header -> sizes[i] = sizes[i];
+        offset = (offset + sizes[i] + 7) & ~(uint64_t)7;
+    }
+}
 
-        // Free the old memory allocation.
-        free(*pWeb);
+// Save the web as a binary snapshot in one sequential write: a header, then
+// the organism table, reverse adjacency, CSR edge arena, interned names,
+// name index and degree buckets exactly as they sit in memory. Returns false
+// if the file cannot be written or memory runs out.
+bool saveWeb(Web* web, const char* path) {
 
-        // Update the pointer to point to the new allocation.
-        *pWeb = newWeb;
+    // A snapshot holds plain CSR: no tombstones and no slack in the arena.
+    if (!compactWeb(web) || !compactEdges(web)) {
+        return false;
+    }
 
-        // Append the new organism at the end.
-        strcpy((*pWeb)[oldCount].name, newOrgName);
-        (*pWeb)[oldCount].prey = NULL;
-        (*pWeb)[oldCount].numPrey = 0;
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "FOODWEB", 8);
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = 0x01020304;
+    header.structSizes[0] = sizeof(Org);
+    header.structSizes[1] = sizeof(OrgLinks);
+    header.structSizes[2] = sizeof(NameEntry);
+    header.numOrgs = web -> numOrgs;
+    header.numEdges = web -> numEdges;
+    header.lenNames = web -> lenNames;
+    header.capNameIndex = web -> capNameIndex;
+    header.numNames = web -> numNames;
+    header.capPredHeads = web -> byNumPred.capHeads;
+    header.capPreyHeads = web -> byNumPrey.capHeads;
+    header.maxNumPred = web -> byNumPred.maxDeg;
+    header.maxNumPrey = web -> byNumPrey.maxDeg;
+    header.heightsValid = web -> heightsValid;
+    layoutSnapshot(web, &header);
 
-        // Update the number of organisms.
-        *pNumOrgs = newCount;
+    const void* sections[NUM_SNAPSHOT_SECTIONS] = {
+        web -> orgs, web -> links, web -> edges, web -> names, web -> nameIndex,
+        web -> byNumPred.heads, web -> byNumPred.prev, web -> byNumPred.next,
+        web -> byNumPrey.heads, web -> byNumPrey.prev, web -> byNumPrey.next
+    };
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        return false;
     }
+    bool ok = (fwrite(&header, sizeof(header), 1, file) == 1);
+    uint64_t pos = sizeof(header);
+    const char padding[8] = {0};
+    for (int i = 0; ok && i < NUM_SNAPSHOT_SECTIONS; i++) {
+        size_t numPad = (size_t)(header.offsets[i] - pos);
+        size_t size = (size_t)header.sizes[i];
+        ok = (fwrite(padding, 1, numPad, file) == numPad) &&
+             (size == 0 || fwrite(sections[i], 1, size, file) == size);
+        pos = header.offsets[i] + size;
+    }
+    ok = (fclose(file) == 0) && ok;
+    return ok;
 }
 
-bool addRelationToWeb(Org* web, int numOrgs, int predInd, int preyInd) {
+// Check every index stored in a mapped snapshot whose header and section
+// sizes already passed, so that a truncated or edited file is rejected
+// instead of sending later commands out of bounds: edge entries and bucket
+// links must name organisms, runs must lie inside the edge arena, names must
+// lie inside the (NUL-terminated) name pool, and the name index must be a
+// power of two holding numNames names and an empty slot to end probes. Each
+// degree bucket list is walked, at most numOrgs steps in all, so that a
+// cycle is caught here rather than spinning a later bucket walk: its links
+// must agree both ways, and it must hold exactly the organisms of its degree.
+bool checkSnapshot(SnapshotHeader* header, char* base) {
+    int numOrgs = header -> numOrgs;
+    int64_t endEdges = 2 * (int64_t)header -> numEdges;
+    int lenNames = header -> lenNames;
+    int capNameIndex = header -> capNameIndex;
+    Org* orgs = (Org*)(base + header -> offsets[0]);
+    OrgLinks* links = (OrgLinks*)(base + header -> offsets[1]);
+    int* edges = (int*)(base + header -> offsets[2]);
+    char* names = base + header -> offsets[3];
+    NameEntry* nameIndex = (NameEntry*)(base + header -> offsets[4]);
 
-    // Check if indices are valid.
-    if (predInd < 0 || predInd >= numOrgs || preyInd < 0  || preyInd >= numOrgs || predInd == preyInd) {
-        printf("Invalid predator and/or prey index. No relation added to the food web.\n");
+    if ((header -> heightsValid != 0 && header -> heightsValid != 1) ||
+        (lenNames > 0 && names[lenNames - 1] != '\0') ||
+        (capNameIndex & (capNameIndex - 1)) != 0 ||
+        header -> numNames < 0 || (capNameIndex > 0 && header -> numNames >= capNameIndex) ||
+        (capNameIndex == 0 && numOrgs > 0)) {
         return false;
     }
+    for (int64_t e = 0; e < endEdges; e++) {
+        if (edges[e] < 0 || edges[e] >= numOrgs) {
+            return false;
+        }
+    }
 
-    Org* predator = &web[predInd];
+    // Runs, names and degrees of every organism.
+    int capHeads[] = {header -> capPredHeads, header -> capPreyHeads};
+    int maxDegs[] = {header -> maxNumPred, header -> maxNumPrey};
+    int64_t numPrey = 0;
+    int64_t numPred = 0;
+    int maxDegsSeen[] = {0, 0};
+    for (int i = 0; i < numOrgs; i++) {
+        Org* org = &(orgs[i]);
+        OrgLinks* link = &(links[i]);
+        unsigned char extinct; // Read as a byte: a bool holding anything but 0 or 1 is undefined.
+        memcpy(&extinct, &(org -> extinct), 1);
+        if (extinct != 0 || org -> nameOff < 0 || org -> nameOff >= lenNames ||
+            org -> numPrey < 0 || org -> preyCap < org -> numPrey || org -> preyStart < 0 ||
+            (int64_t)org -> preyStart + org -> preyCap > endEdges ||
+            link -> numPred < 0 || link -> predCap < link -> numPred || link -> predStart < 0 ||
+            (int64_t)link -> predStart + link -> predCap > endEdges ||
+            link -> numProducerPrey < 0 || link -> numProducerPrey > org -> numPrey ||
+            link -> numPred >= capHeads[0] || org -> numPrey >= capHeads[1] ||
+            (header -> heightsValid && (link -> height < -1 || link -> height >= numOrgs))) {
+            return false; // A snapshot holds no tombstones either.
+        }
+        numPrey += org -> numPrey;
+        numPred += link -> numPred;
+        maxDegsSeen[0] = (link -> numPred > maxDegsSeen[0]) ? link -> numPred : maxDegsSeen[0];
+        maxDegsSeen[1] = (org -> numPrey > maxDegsSeen[1]) ? org -> numPrey : maxDegsSeen[1];
+    }
+    if (numPrey != header -> numEdges || numPred != header -> numEdges) {
+        return false;
+    }
 
-    // Check for duplicate relation.
-    for (int i =0; i < predator -> numPrey; i++) {
-        if (predator -> prey[i] == preyInd) {
-            printf("Duplicate predator/prey relation. No relation added to the food web.\n");
+    // Name index entries (only the name offset of an empty slot is ever read).
+    int numNames = 0;
+    for (int i = 0; i < capNameIndex; i++) {
+        NameEntry* entry = &(nameIndex[i]);
+        if (entry -> nameOff == -1) {
+            continue;
+        }
+        if (entry -> nameOff < 0 || entry -> nameOff >= lenNames || entry -> orgInd < -1 ||
+            entry -> orgInd >= numOrgs || entry -> refs < 0) {
             return false;
         }
+        numNames++;
+    }
+    if (numNames != header -> numNames || (capNameIndex > 0 && numNames == capNameIndex)) {
+        return false;
     }
 
-    // Handle memory allocation.
-    int newSize = predator -> numPrey + 1;
-    int* newPrey = NULL;
+    // Degree bucket heads and links.
+    for (int b = 0; b < 2; b++) {
+        int* heads = (int*)(base + header -> offsets[5 + 3 * b]);
+        int* prev = (int*)(base + header -> offsets[6 + 3 * b]);
+        int* next = (int*)(base + header -> offsets[7 + 3 * b]);
+        if (maxDegs[b] != maxDegsSeen[b] || (numOrgs > 0 && maxDegs[b] >= capHeads[b])) {
+            return false;
+        }
+        for (int i = 0; i < numOrgs; i++) {
+            if (prev[i] < -1 || prev[i] >= numOrgs || next[i] < -1 || next[i] >= numOrgs) {
+                return false;
+            }
+        }
+        int numSteps = 0;
+        for (int d = 0; d < capHeads[b]; d++) {
+            if (heads[d] < -1 || heads[d] >= numOrgs) {
+                return false;
+            }
+            int before = -1;
+            for (int i = heads[d]; i != -1; i = next[i]) {
+                int deg = (b == 0) ? links[i].numPred : orgs[i].numPrey;
+                if (++numSteps > numOrgs || prev[i] != before || deg != d) {
+                    return false;
+                }
+                before = i;
+            }
+        }
+        if (numSteps != numOrgs) {
+            return false; // Some organism is in no bucket.
+        }
+    }
+    return true;
+}
 
-    if (predator -> numPrey == 0) {
-        newPrey = (int*)malloc(sizeof(int));
-    } else {
-        newPrey = (int*)malloc(newSize * sizeof(int));
-        if (newPrey != NULL) {
-            for (int i = 0; i < predator -> numPrey; i++) {
-                newPrey[i] = predator -> prey[i];
+// Load a snapshot written by saveWeb() into an empty web by mapping the file
+// and pointing the web's arrays into it: nothing is parsed or copied, so
+// analysis can start at once once checkSnapshot() has vetted its indices.
+// Pages are mapped copy-on-write, and the first change to the web copies the
+// arrays out (see detachSnapshot()). Returns false if the file cannot be
+// mapped or is not a compatible, consistent snapshot.
+bool loadWeb(Web* web, const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(SnapshotHeader)) {
+        close(fd);
+        return false;
+    }
+    size_t lenFile = (size_t)info.st_size;
+    void* mapping = mmap(NULL, lenFile, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    char* base = (char*)mapping;
+
+    // Check that the header matches this build and every section fits.
+    SnapshotHeader* header = (SnapshotHeader*)base;
+    bool ok = memcmp(header -> magic, "FOODWEB", 8) == 0 &&
+              header -> version == SNAPSHOT_VERSION &&
+              header -> byteOrder == 0x01020304 &&
+              header -> structSizes[0] == sizeof(Org) &&
+              header -> structSizes[1] == sizeof(OrgLinks) &&
+              header -> structSizes[2] == sizeof(NameEntry) &&
+              header -> numOrgs >= 0 && header -> numEdges >= 0 && header -> lenNames >= 0 &&
+              header -> capNameIndex >= 0 && header -> capPredHeads >= 0 && header -> capPreyHeads >= 0;
+    if (ok) {
+        Web shape; // Only the counts are read by layoutSnapshot().
+        memset(&shape, 0, sizeof(shape));
+        shape.numOrgs = header -> numOrgs;
+        shape.numEdges = header -> numEdges;
+        shape.lenNames = header -> lenNames;
+        shape.capNameIndex = header -> capNameIndex;
+        shape.byNumPred.capHeads = header -> capPredHeads;
+        shape.byNumPrey.capHeads = header -> capPreyHeads;
+        SnapshotHeader expected;
+        memset(&expected, 0, sizeof(expected));
+        layoutSnapshot(&shape, &expected);
+        for (int i = 0; i < NUM_SNAPSHOT_SECTIONS; i++) {
+            ok = ok && header -> offsets[i] == expected.offsets[i] && header -> sizes[i] == expected.sizes[i] &&
+                 header -> offsets[i] + header -> sizes[i] <= lenFile;
+        }
+    }
+    if (!ok || !checkSnapshot(header, base)) {
+        munmap(mapping, lenFile);
+        return false;
+    }
+
+    freeWeb(web);
+    web -> snapshot = base;
+    web -> lenSnapshot = lenFile;
+    web -> orgs = (Org*)(base + header -> offsets[0]);
+    web -> numOrgs = header -> numOrgs;
+    web -> capOrgs = header -> numOrgs;
+    web -> links = (OrgLinks*)(base + header -> offsets[1]);
+    web -> edges = (int*)(base + header -> offsets[2]);
+    web -> numEdges = header -> numEdges;
+    web -> endEdges = 2 * header -> numEdges;
+    web -> capEdges = 2 * header -> numEdges;
+    web -> names = base + header -> offsets[3];
+    web -> lenNames = header -> lenNames;
+    web -> capNames = header -> lenNames;
+    web -> nameIndex = (NameEntry*)(base + header -> offsets[4]);
+    web -> capNameIndex = header -> capNameIndex;
+    web -> numNames = header -> numNames;
+    Buckets* bucketSets[] = {&(web -> byNumPred), &(web -> byNumPrey)};
+    int capHeads[] = {header -> capPredHeads, header -> capPreyHeads};
+    int maxDegs[] = {header -> maxNumPred, header -> maxNumPrey};
+    for (int b = 0; b < 2; b++) {
+        bucketSets[b] -> heads = (int*)(base + header -> offsets[5 + 3 * b]);
+        bucketSets[b] -> prev = (int*)(base + header -> offsets[6 + 3 * b]);
+        bucketSets[b] -> next = (int*)(base + header -> offsets[7 + 3 * b]);
+        bucketSets[b] -> capHeads = capHeads[b];
+        bucketSets[b] -> maxDeg = maxDegs[b];
+    }
+    web -> heightsValid = header -> heightsValid;
+    return true;
+}
+
+
+// Remove one organism in thought only and count the secondary extinctions:
+// consumers left with no prey, propagated until no more die out. The web is
+// only read. numLeft counts each reached predator's surviving prey and is
+// valid where stamps holds the run number, so it never needs clearing between
+// runs; stack holds organisms whose predators are still to be visited.
+int knockOut(Web* web, int orgInd, int run, int* stamps, int* numLeft, int* stack) {
+    Org* orgs = web -> orgs;
+    int numLost = 0;
+    int top = 0;
+    stamps[orgInd] = run;
+    numLeft[orgInd] = 0; // Never counted down to zero again, even in a cycle.
+    stack[top++] = orgInd;
+    while (top > 0) {
+        int lostInd = stack[--top];
+        int* preds = predsOf(web, lostInd);
+        for (int i = 0; i < web -> links[lostInd].numPred; i++) {
+            int predInd = preds[i];
+            if (stamps[predInd] != run) {
+                stamps[predInd] = run;
+                numLeft[predInd] = orgs[predInd].numPrey;
+            }
+            if (--numLeft[predInd] == 0) {
+                stack[top++] = predInd;
+                numLost++;
             }
-            free(predator -> prey);
         }
     }
+    return numLost;
+}
 
-    if (newPrey == NULL) {
-        return false; // memory allocation failed
+// Rank the live organisms by the secondary extinctions their removal would
+// cause, most first and then by index. Every knockout runs on the same
+// unchanged web, so they are spread across threads when compiled with OpenMP.
+// Leaves the count for every organism at the start of the scratch worklist,
+// followed by the ranked organisms, and returns how many were ranked (-1 if
+// the scratch space could not be allocated).
+int rankKeystones(Web* web) {
+    int numOrgs = web -> numOrgs;
+    int numThreads = 1;
+#ifdef _OPENMP
+    if (web -> numEdges >= PARALLEL_MIN_EDGES) {
+        numThreads = omp_get_max_threads();
+    }
+#endif
+
+    // Counts and ranking, then a stamp, count and stack array per thread
+    // (reused for the counting sort once the knockouts are done).
+    int64_t numSlots = 2 * (int64_t)numOrgs + 3 * (int64_t)numOrgs * numThreads + 1;
+    if (numSlots > INT32_MAX || !reserveWork(web, (int)numSlots)) {
+        return -1; // Memory allocation failed.
+    }
+    int* numLost = web -> work;
+    int* ranking = numLost + numOrgs;
+    int* scratch = ranking + numOrgs;
+    for (int i = 0; i < 3 * numOrgs * numThreads; i++) {
+        scratch[i] = -1;
+    }
+
+    if (numThreads > 1) {
+#ifdef _OPENMP
+        #pragma omp parallel num_threads(numThreads)
+        {
+            int* stamps = scratch + 3 * numOrgs * omp_get_thread_num();
+            #pragma omp for schedule(dynamic, 64)
+            for (int i = 0; i < numOrgs; i++) {
+                numLost[i] = web -> orgs[i].extinct ? -1 : knockOut(web, i, i, stamps, stamps + numOrgs, stamps + 2 * numOrgs);
+            }
+        }
+#endif
+    } else {
+        for (int i = 0; i < numOrgs; i++) {
+            numLost[i] = web -> orgs[i].extinct ? -1 : knockOut(web, i, i, scratch, scratch + numOrgs, scratch + 2 * numOrgs);
+        }
+    }
+
+    // Counting sort by secondary extinctions, most first; organisms with equal
+    // counts stay in index order.
+    int* numWithLost = scratch;
+    for (int n = 0; n < numOrgs; n++) {
+        numWithLost[n] = 0;
+    }
+    int numRanked = 0;
+    for (int i = 0; i < numOrgs; i++) {
+        if (numLost[i] >= 0) {
+            numWithLost[numLost[i]]++;
+            numRanked++;
+        }
+    }
+    int start = 0;
+    for (int n = numOrgs - 1; n >= 0; n--) {
+        int count = numWithLost[n];
+        numWithLost[n] = start;
+        start += count;
+    }
+    for (int i = 0; i < numOrgs; i++) {
+        if (numLost[i] >= 0) {
+            ranking[numWithLost[numLost[i]]++] = i;
+        }
+    }
+    return numRanked;
+}
+
+
+void initBranchSet(BranchSet* set) {
+    set -> branches = NULL;
+    set -> numBranches = 0;
+    set -> capBranches = 0;
+    set -> numOrgs = 0;
+    set -> depth = 0;
+    set -> names = NULL;
+    set -> lenNames = 0;
+    set -> numNodes = 0;
+    set -> numRecords = 0;
+    set -> numBlocks = 0;
+}
+
+// Allocate a block for cap indices, owned by one record.
+PBlock* newBranchBlock(BranchSet* set, int cap) {
+    PBlock* block = (PBlock*)malloc(sizeof(PBlock) + (size_t)cap * sizeof(int));
+    if (block == NULL) {
+        return NULL; // Memory allocation failed.
+    }
+    block -> refs = 1;
+    block -> num = 0;
+    block -> cap = cap;
+    set -> numBlocks++;
+    return block;
+}
+
+// Copy a block of num indices into a new record-owned block (NULL if none).
+PBlock* copyToBranchBlock(BranchSet* set, const int* items, int num, bool* pOk) {
+    if (num == 0) {
+        return NULL;
+    }
+    PBlock* block = newBranchBlock(set, num);
+    if (block == NULL) {
+        *pOk = false;
+        return NULL;
+    }
+    memcpy(block -> items, items, (size_t)num * sizeof(int));
+    block -> num = num;
+    return block;
+}
+
+void dropBranchBlock(BranchSet* set, PBlock* block) {
+    if (block != NULL && --(block -> refs) == 0) {
+        free(block);
+        set -> numBlocks--;
+    }
+}
+
+void dropBranchRecord(BranchSet* set, POrg* org) {
+    if (org != NULL && --(org -> refs) == 0) {
+        dropBranchBlock(set, org -> prey);
+        dropBranchBlock(set, org -> preds);
+        free(org);
+        set -> numRecords--;
+    }
+}
+
+// Release one reference to a trie node at the given level, and everything
+// below it that no other node shares.
+void dropBranchNode(BranchSet* set, PNode* node, int level) {
+    if (node == NULL || --(node -> refs) > 0) {
+        return;
+    }
+    for (int k = 0; k < BRANCH_FANOUT; k++) {
+        if (level == set -> depth) {
+            dropBranchRecord(set, (POrg*)node -> kids[k]);
+        } else {
+            dropBranchNode(set, (PNode*)node -> kids[k], level + 1);
+        }
+    }
+    free(node);
+    set -> numNodes--;
+}
+
+void freeBranchSet(BranchSet* set) {
+    for (int b = 0; b < set -> numBranches; b++) {
+        dropBranchNode(set, set -> branches[b].root, 0);
+    }
+    free(set -> branches);
+    free(set -> names);
+    initBranchSet(set);
+}
+
+// Build the trie node at the given level covering the organisms from
+// firstInd on, with a record per organism copied from the web.
+PNode* freezeBranchNode(BranchSet* set, Web* web, int firstInd, int level) {
+    PNode* node = (PNode*)calloc(1, sizeof(PNode));
+    if (node == NULL) {
+        return NULL; // Memory allocation failed.
+    }
+    node -> refs = 1;
+    set -> numNodes++;
+    int64_t span = (int64_t)1 << (BRANCH_BITS * (set -> depth - level)); // organisms under each kid
+    bool ok = true;
+    for (int k = 0; k < BRANCH_FANOUT && ok && firstInd + k * span < set -> numOrgs; k++) {
+        int orgInd = (int)(firstInd + k * span);
+        if (level < set -> depth) {
+            node -> kids[k] = freezeBranchNode(set, web, orgInd, level + 1);
+            ok = (node -> kids[k] != NULL);
+            continue;
+        }
+        POrg* org = (POrg*)malloc(sizeof(POrg));
+        if (org == NULL) {
+            ok = false;
+            break;
+        }
+        set -> numRecords++;
+        node -> kids[k] = org;
+        org -> refs = 1;
+        org -> nameOff = web -> orgs[orgInd].nameOff;
+        org -> extinct = web -> orgs[orgInd].extinct;
+        org -> prey = copyToBranchBlock(set, preyOf(web, orgInd), web -> orgs[orgInd].numPrey, &ok);
+        org -> preds = copyToBranchBlock(set, predsOf(web, orgInd), web -> links[orgInd].numPred, &ok);
+    }
+    if (!ok) {
+        dropBranchNode(set, node, level);
+        return NULL;
+    }
+    return node;
+}
+
+// Start a branch set whose branch 0 is a copy of the web as it is now.
+// Organisms keep the web's indices in every branch. Returns false if memory
+// runs out.
+bool freezeWeb(Web* web, BranchSet* set) {
+    initBranchSet(set);
+    set -> numOrgs = web -> numOrgs;
+    for (int64_t span = BRANCH_FANOUT; span < set -> numOrgs; span *= BRANCH_FANOUT) {
+        set -> depth++;
+    }
+    set -> names = (char*)malloc((size_t)web -> lenNames + 1);
+    set -> branches = (Branch*)malloc(4 * sizeof(Branch));
+    if (set -> names == NULL || set -> branches == NULL) {
+        freeBranchSet(set);
+        return false; // Memory allocation failed.
+    }
+    memcpy(set -> names, web -> names, (size_t)web -> lenNames);
+    set -> lenNames = web -> lenNames;
+    set -> capBranches = 4;
+
+    Branch* branch = &(set -> branches[0]);
+    branch -> root = freezeBranchNode(set, web, 0, 0);
+    branch -> numLive = web -> numOrgs - web -> numExtinct;
+    branch -> numEdges = web -> numEdges;
+    if (branch -> root == NULL) {
+        freeBranchSet(set);
+        return false;
+    }
+    set -> numBranches = 1;
+    return true;
+}
+
+// Add a branch identical to branch fromInd in O(1) by sharing its root.
+// Returns the new branch's number, or -1 if memory runs out.
+int forkBranch(BranchSet* set, int fromInd) {
+    if (set -> numBranches == set -> capBranches) {
+        Branch* newBranches = (Branch*)realloc(set -> branches, 2 * set -> capBranches * sizeof(Branch));
+        if (newBranches == NULL) {
+            return -1; // Memory allocation failed.
+        }
+        set -> branches = newBranches;
+        set -> capBranches *= 2;
+    }
+    set -> branches[set -> numBranches] = set -> branches[fromInd];
+    set -> branches[fromInd].root -> refs++;
+    return set -> numBranches++;
+}
+
+// An organism's record in a branch, for reading only.
+POrg* branchOrg(BranchSet* set, Branch* branch, int orgInd) {
+    PNode* node = branch -> root;
+    for (int level = 0; level < set -> depth; level++) {
+        node = (PNode*)node -> kids[(orgInd >> (BRANCH_BITS * (set -> depth - level))) & (BRANCH_FANOUT - 1)];
+    }
+    return (POrg*)node -> kids[orgInd & (BRANCH_FANOUT - 1)];
+}
+
+// Give a node at the given level a private copy in place of one still shared.
+PNode* copyBranchNode(BranchSet* set, PNode* node, int level) {
+    PNode* copy = (PNode*)malloc(sizeof(PNode));
+    if (copy == NULL) {
+        return NULL; // Memory allocation failed.
+    }
+    set -> numNodes++;
+    memcpy(copy -> kids, node -> kids, sizeof(node -> kids));
+    copy -> refs = 1;
+    for (int k = 0; k < BRANCH_FANOUT; k++) {
+        if (copy -> kids[k] != NULL && level == set -> depth) {
+            ((POrg*)copy -> kids[k]) -> refs++;
+        } else if (copy -> kids[k] != NULL) {
+            ((PNode*)copy -> kids[k]) -> refs++;
+        }
+    }
+    node -> refs--;
+    return copy;
+}
+
+// An organism's record in a branch, ready to change: the trie path down to
+// it and the record itself are copied wherever another branch shares them.
+// Returns NULL if memory runs out.
+POrg* touchBranchOrg(BranchSet* set, Branch* branch, int orgInd) {
+    if (branch -> root -> refs > 1) {
+        PNode* copy = copyBranchNode(set, branch -> root, 0);
+        if (copy == NULL) {
+            return NULL;
+        }
+        branch -> root = copy;
+    }
+    PNode* node = branch -> root;
+    for (int level = 0; level < set -> depth; level++) {
+        int digit = (orgInd >> (BRANCH_BITS * (set -> depth - level))) & (BRANCH_FANOUT - 1);
+        PNode* kid = (PNode*)node -> kids[digit];
+        if (kid -> refs > 1) {
+            kid = copyBranchNode(set, kid, level + 1);
+            if (kid == NULL) {
+                return NULL;
+            }
+            node -> kids[digit] = kid;
+        }
+        node = kid;
     }
 
-    newPrey[newSize -1] = preyInd;
-    predator -> prey = newPrey;
-    predator -> numPrey = newSize;
+    int digit = orgInd & (BRANCH_FANOUT - 1);
+    POrg* org = (POrg*)node -> kids[digit];
+    if (org -> refs > 1) {
+        POrg* copy = (POrg*)malloc(sizeof(POrg));
+        if (copy == NULL) {
+            return NULL; // Memory allocation failed.
+        }
+        set -> numRecords++;
+        *copy = *org;
+        copy -> refs = 1;
+        if (copy -> prey != NULL) {
+            copy -> prey -> refs++;
+        }
+        if (copy -> preds != NULL) {
+            copy -> preds -> refs++;
+        }
+        org -> refs--;
+        node -> kids[digit] = copy;
+        org = copy;
+    }
+    return org;
+}
 
+// Make the block at pBlock private to its record with room for at least
+// minCap indices, copying it if it is shared or too small.
+bool touchBranchBlock(BranchSet* set, PBlock** pBlock, int minCap) {
+    PBlock* block = *pBlock;
+    int num = (block != NULL) ? block -> num : 0;
+    if (block != NULL && block -> refs == 1 && block -> cap >= minCap) {
+        return true;
+    }
+    int newCap = num;
+    if (minCap > num) {
+        newCap = (num > 0) ? 2 * num : 4;
+        while (newCap < minCap) {
+            newCap *= 2;
+        }
+    }
+    PBlock* copy = newBranchBlock(set, newCap);
+    if (copy == NULL) {
+        return false;
+    }
+    if (num > 0) {
+        memcpy(copy -> items, block -> items, (size_t)num * sizeof(int));
+    }
+    copy -> num = num;
+    dropBranchBlock(set, block);
+    *pBlock = copy;
     return true;
 }
 
-bool removeOrgFromWeb(Org** pWeb, int* pNumOrgs, int index) {
+// Add a relation to one branch. Returns false if either organism is invalid
+// or extinct in the branch, the relation is already there, or memory runs out.
+bool addBranchRelation(BranchSet* set, int branchInd, int predInd, int preyInd) {
+    Branch* branch = &(set -> branches[branchInd]);
+    if (predInd < 0 || predInd >= set -> numOrgs || preyInd < 0 || preyInd >= set -> numOrgs || predInd == preyInd) {
+        return false;
+    }
+    POrg* predator = branchOrg(set, branch, predInd);
+    POrg* prey = branchOrg(set, branch, preyInd);
+    if (predator -> extinct || prey -> extinct) {
+        return false;
+    }
+    for (int j = 0; predator -> prey != NULL && j < predator -> prey -> num; j++) {
+        if (predator -> prey -> items[j] == preyInd) {
+            return false;
+        }
+    }
+
+    predator = touchBranchOrg(set, branch, predInd);
+    if (predator == NULL || !touchBranchBlock(set, &(predator -> prey), predator -> prey ? predator -> prey -> num + 1 : 1)) {
+        return false;
+    }
+    predator -> prey -> items[predator -> prey -> num++] = preyInd;
+    prey = touchBranchOrg(set, branch, preyInd);
+    if (prey == NULL || !touchBranchBlock(set, &(prey -> preds), prey -> preds ? prey -> preds -> num + 1 : 1)) {
+        return false;
+    }
+    prey -> preds -> items[prey -> preds -> num++] = predInd;
+    branch -> numEdges++;
+    return true;
+}
 
-    // Check if the index is valid.
-    if (index < 0 || index >= *pNumOrgs) {
-        printf("Invalid extinction index. No organism removed from the food web.\n");
+// Make an organism extinct in one branch, detaching it the same way
+// removeOrgFromWeb() does. Returns false if it is invalid or already extinct
+// in the branch, or memory runs out.
+bool removeBranchOrg(BranchSet* set, int branchInd, int orgInd) {
+    Branch* branch = &(set -> branches[branchInd]);
+    if (orgInd < 0 || orgInd >= set -> numOrgs || branchOrg(set, branch, orgInd) -> extinct) {
+        return false;
+    }
+    POrg* org = touchBranchOrg(set, branch, orgInd);
+    if (org == NULL) {
         return false;
     }
 
-    Org* oldWeb = *pWeb;
-    int oldNumOrgs = *pNumOrgs;
-    int newNumOrgs = oldNumOrgs - 1;
-    Org* newWeb = NULL;
+    // The extinct record lets go of its blocks; this keeps them alive until
+    // its neighbours are detached.
+    PBlock* prey = org -> prey;
+    PBlock* preds = org -> preds;
+    org -> extinct = true;
+    org -> prey = NULL;
+    org -> preds = NULL;
+    branch -> numLive--;
 
-    // (1) Create the new web array without an organism at index
-    if (newNumOrgs > 0) {
-        newWeb = (Org*)malloc(newNumOrgs * sizeof(Org));
-        if (newWeb == NULL) {
-            return false; // Memory allocation failed.
+    // Drop it from its prey's predator blocks, and from its predators' prey
+    // blocks keeping their order.
+    bool ok = true;
+    for (int j = 0; ok && prey != NULL && j < prey -> num; j++) {
+        POrg* preyOrg = touchBranchOrg(set, branch, prey -> items[j]);
+        ok = (preyOrg != NULL && touchBranchBlock(set, &(preyOrg -> preds), 0));
+        for (int i = 0; ok && i < preyOrg -> preds -> num; i++) {
+            if (preyOrg -> preds -> items[i] == orgInd) {
+                preyOrg -> preds -> items[i] = preyOrg -> preds -> items[--(preyOrg -> preds -> num)];
+                branch -> numEdges--;
+                break;
+            }
+        }
+    }
+    for (int j = 0; ok && preds != NULL && j < preds -> num; j++) {
+        POrg* predator = touchBranchOrg(set, branch, preds -> items[j]);
+        ok = (predator != NULL && touchBranchBlock(set, &(predator -> prey), 0));
+        int k = 0;
+        for (int i = 0; ok && i < predator -> prey -> num; i++) {
+            if (predator -> prey -> items[i] != orgInd) {
+                predator -> prey -> items[k++] = predator -> prey -> items[i];
+            }
+        }
+        if (ok) {
+            branch -> numEdges -= predator -> prey -> num - k;
+            predator -> prey -> num = k;
+        }
+    }
+    dropBranchBlock(set, prey);
+    dropBranchBlock(set, preds);
+    return ok;
+}
+
+// Fill an empty web with the live organisms of one branch, in index order,
+// and its relations, so every analysis can run on it. Returns false if
+// memory runs out.
+bool thawBranch(BranchSet* set, int branchInd, Web* web) {
+    Branch* branch = &(set -> branches[branchInd]);
+    int* newInd = (int*)malloc(((size_t)set -> numOrgs + 1) * sizeof(int));
+    bool ok = (newInd != NULL);
+    for (int i = 0; ok && i < set -> numOrgs; i++) {
+        POrg* org = branchOrg(set, branch, i);
+        newInd[i] = org -> extinct ? -1 : web -> numOrgs;
+        ok = org -> extinct || addOrgToWeb(web, set -> names + org -> nameOff);
+    }
+    ok = ok && reserveSpare(web, branch -> numEdges);
+
+    // Lay out the prey runs back to back, as importWeb() does, and derive
+    // the rest from them.
+    if (ok) {
+        int* newPrey = web -> spare;
+        int offset = 0;
+        for (int i = 0; i < set -> numOrgs; i++) {
+            if (newInd[i] == -1) {
+                continue;
+            }
+            PBlock* prey = branchOrg(set, branch, i) -> prey;
+            Org* org = &(web -> orgs[newInd[i]]);
+            org -> preyStart = offset;
+            org -> numPrey = (prey != NULL) ? prey -> num : 0;
+            for (int j = 0; j < org -> numPrey; j++) {
+                newPrey[offset++] = newInd[prey -> items[j]];
+            }
         }
+        swapSpare(web, offset);
+        web -> numEdges = offset;
+        web -> version++;
+        ok = rebuildEdgeIndex(web, offset) && rebuildLinks(web);
+        web -> heightsValid = false;
+    }
+    free(newInd);
+    return ok;
+}
 
-        // Copy organisms before the index.
-        for (int i = 0; i < index; i++) {
-            newWeb[i] = oldWeb[i];
+// Free the retired views that no reader can still be reading: those retired
+// at or before the oldest epoch a reader slot pins.
+void reclaimViews(SnapshotPublisher* pub) {
+    unsigned long oldest = (unsigned long)-1;
+    for (int r = 0; r < MAX_SNAPSHOT_READERS; r++) {
+        unsigned long pinned = atomic_load(&(pub -> readers[r]));
+        if (pinned != 0 && pinned < oldest) {
+            oldest = pinned;
+        }
+    }
+    WebView** pView = &(pub -> retired);
+    while (*pView != NULL) {
+        WebView* view = *pView;
+        if (view -> retiredAt <= oldest) {
+            *pView = view -> nextRetired;
+            dropBranchNode(&(pub -> set), view -> branch.root, 0);
+            free(view);
+            pub -> numRetired--;
+        } else {
+            pView = &(view -> nextRetired);
         }
+    }
+}
+
+// Make the writer's branch as it is now the view new readers get. Returns
+// false if memory runs out, leaving the previous view current.
+bool publishWeb(SnapshotPublisher* pub) {
+    WebView* view = (WebView*)malloc(sizeof(WebView));
+    if (view == NULL) {
+        return false; // Memory allocation failed.
+    }
+    view -> branch = pub -> set.branches[0];
+    view -> branch.root -> refs++;
+    view -> nextRetired = NULL;
+
+    // Readers that pin the new epoch are sure to see the new view.
+    WebView* old = atomic_exchange(&(pub -> current), view);
+    if (old != NULL) {
+        old -> retiredAt = atomic_fetch_add(&(pub -> epoch), 1) + 1;
+        old -> nextRetired = pub -> retired;
+        pub -> retired = old;
+        pub -> numRetired++;
+    }
+    reclaimViews(pub);
+    return true;
+}
+
+// Freeze the web as the writer's branch and publish it. Returns false if
+// memory runs out.
+bool initPublisher(Web* web, SnapshotPublisher* pub) {
+    atomic_init(&(pub -> current), NULL);
+    atomic_init(&(pub -> epoch), 1);
+    for (int r = 0; r < MAX_SNAPSHOT_READERS; r++) {
+        atomic_init(&(pub -> readers[r]), 0);
+    }
+    pub -> retired = NULL;
+    pub -> numRetired = 0;
+    if (!freezeWeb(web, &(pub -> set))) {
+        return false;
+    }
+    if (!publishWeb(pub)) {
+        freeBranchSet(&(pub -> set));
+        return false;
+    }
+    return true;
+}
+
+// Called once no reader is left.
+void freePublisher(SnapshotPublisher* pub) {
+    WebView* view = atomic_exchange(&(pub -> current), NULL);
+    if (view != NULL) {
+        view -> retiredAt = 0;
+        view -> nextRetired = pub -> retired;
+        pub -> retired = view;
+        pub -> numRetired++;
+    }
+    reclaimViews(pub);
+    freeBranchSet(&(pub -> set));
+}
+
+// Start reading in the given reader slot (one per reading thread). The view
+// returned stays unchanged and allocated until endRead() on the same slot.
+WebView* beginRead(SnapshotPublisher* pub, int slot) {
+    atomic_store(&(pub -> readers[slot]), atomic_load(&(pub -> epoch)));
+    return atomic_load(&(pub -> current));
+}
+
+void endRead(SnapshotPublisher* pub, int slot) {
+    atomic_store_explicit(&(pub -> readers[slot]), 0, memory_order_release);
+}
+
+// printf() to a stream, or nothing at all when it is NULL, so that the
+// analysis behind a report can run (and be timed) without formatting it.
+void printTo(FILE* out, const char* format, ...) {
+    if (out == NULL) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    vfprintf(out, format, args);
+    va_end(args);
+}
 
-        // Copy organisms after the index.
-        for (int i = index; i < newNumOrgs; i++) {
-            newWeb[i] = oldWeb[i + 1];
+void printWeb(Web* web, FILE* out) {
+
+    // Printed indices are the live ranks users type back in (see
+    // selectLiveOrg()), so printing never has to renumber the web.
+    Org* orgs = web -> orgs;
+    int* edges = web -> edges;
+    char* names = web -> names;
+    int numOrgs = web -> numOrgs;
+    int rank = 0;
+    for (int i = 0; i < numOrgs; i++) {
+        if (orgs[i].extinct) {
+            continue;
+        }
+        printTo(out, "  (%d) %s", rank++, names + orgs[i].nameOff);
+        if (orgs[i].numPrey > 0) {
+            printTo(out, " eats ");
+            for (int j = 0; j < orgs[i].numPrey; j++) {
+                if (j > 0) {
+                    printTo(out, ", ");
+                }
+                printTo(out, "%s", names + orgs[edges[orgs[i].preyStart + j]].nameOff);
+            }
         }
+        printTo(out, "\n");
     }
+}
 
-    // Free the prey array of the extinct organism.
-    free(oldWeb[index].prey);
 
-    // Free the old web array.
-    free(oldWeb);
+int compareInts(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Print the organisms in one degree bucket in index order, in
+// O(k log k) for a bucket of k organisms.
+void printBucket(Web* web, Buckets* buckets, int deg, FILE* out) {
+    int count = 0;
+    for (int i = buckets -> heads[deg]; i != -1; i = buckets -> next[i]) {
+        count++;
+    }
+    if (!reserveWork(web, count)) {
+        return; // Memory allocation failed.
+    }
+    int* members = web -> work;
+    count = 0;
+    for (int i = buckets -> heads[deg]; i != -1; i = buckets -> next[i]) {
+        members[count++] = i;
+    }
+    qsort(members, count, sizeof(int), compareInts);
+    for (int k = 0; k < count; k++) {
+        printTo(out, "  %s\n", orgName(web, members[k]));
+    }
+}
 
-    // Update the web pointer and number of organisms.
-    *pWeb = newWeb;
-    *pNumOrgs = newNumOrgs;
+// Analyze the web and print the report to out; a NULL out runs the same
+// analysis without printing (see printTo()).
+void displayAll(Web* web, bool modified, FILE* out) {
 
-    // If there are no organisms left, return immediately.
-    if (newNumOrgs == 0) {
-        return true;
+    // Tombstones are skipped, not compacted away: displaying never renumbers
+    // the web (extinct organisms sit in no bucket and on no cycle).
+    Org* orgs = web -> orgs;
+    char* names = web -> names;
+    int numOrgs = web -> numOrgs;
+    int numLive = numOrgs - web -> numExtinct;
+
+    if (modified) printTo(out, "UPDATED ");
+    printTo(out, "Food Web Predators & Prey:\n");
+    printWeb(web, out);
+    printTo(out, "\n");
+
+    // Apex Predators: not eaten by any other (the in-degree 0 bucket).
+    if (modified) printTo(out, "UPDATED ");
+    printTo(out, "Apex Predators:\n");
+    if (numLive > 0) {
+        printBucket(web, &(web -> byNumPred), 0, out);
     }
+    printTo(out, "\n");
 
-    // (2) Update all prey arrays.
-    for (int i = 0; i < newNumOrgs; i++) {
-        Org* org = &((*pWeb)[i]);
+    // Producers: eat nothing (the out-degree 0 bucket).
+    if (modified) printTo(out, "UPDATED ");
+    printTo(out, "Producers:\n");
+    if (numLive > 0) {
+        printBucket(web, &(web -> byNumPrey), 0, out);
+    }
+    printTo(out, "\n");
+
+    // Most Flexible Eaters: most prey (the highest out-degree bucket).
+    if (modified) printTo(out, "UPDATED ");
+    printTo(out, "Most Flexible Eaters:\n");
+    if (web -> byNumPrey.maxDeg > 0) {
+        printBucket(web, &(web -> byNumPrey), web -> byNumPrey.maxDeg, out);
+    }
+    printTo(out, "\n");
+
+    // Tastiest Food: most eaten (the highest in-degree bucket).
+    if (modified) printTo(out, "UPDATED ");
+    printTo(out, "Tastiest Food:\n");
+    if (web -> byNumPred.maxDeg > 0) {
+        printBucket(web, &(web -> byNumPred), web -> byNumPred.maxDeg, out);
+    }
+    printTo(out, "\n");
 
-        // Skip organisms with no prey
-        if (org -> numPrey == 0) {
+    // Food Web Height, kept up to date as relations are added. A web with
+    // feeding cycles is measured on its condensation instead, where every
+    // organism of a cycle shares the height of its component.
+    if (modified) printTo(out, "UPDATED ");
+    printTo(out, "Food Web Heights:\n");
+    if (!web -> heightsValid) {
+        recomputeHeights(web);
+    }
+    bool hasCycles = !web -> heightsValid && condenseWeb(web);
+    Condensation* cond = &(web -> cond);
+    for (int i = 0; i < numOrgs; i++) {
+        if (orgs[i].extinct) {
+            continue;
+        }
+        if (!hasCycles) {
+            printTo(out, "  %s: %d\n", names + orgs[i].nameOff, web -> links[i].height);
             continue;
         }
+        int c = cond -> compOf[i];
+        printTo(out, "  %s: %d", names + orgs[i].nameOff, cond -> height[c]);
+        if (cond -> memberStart[c + 1] - cond -> memberStart[c] > 1) {
+            printTo(out, " (feeding cycle)");
+        }
+        printTo(out, "\n");
+    }
+    printTo(out, "\n");
 
-        // Check if the prey array contains the extinct index.
-        bool found = false;
-        for (int j = 0; j < org -> numPrey; j++) {
-            if (org -> prey[j] == index) {
-                found = true;
-                break;
+    // Feeding Cycles: components with more than one organism, listed only
+    // when the web has any. Apex cycles are eaten by nothing outside them;
+    // producer cycles eat nothing outside them.
+    if (hasCycles) {
+        if (modified) printTo(out, "UPDATED ");
+        printTo(out, "Feeding Cycles:\n");
+        for (int c = 0; c < cond -> numComps; c++) {
+            if (cond -> memberStart[c + 1] - cond -> memberStart[c] < 2) {
+                continue;
+            }
+            printTo(out, " ");
+            for (int m = cond -> memberStart[c]; m < cond -> memberStart[c + 1]; m++) {
+                printTo(out, " %s", names + orgs[cond -> members[m]].nameOff);
             }
+            printTo(out, " (height %d", cond -> height[c]);
+            if (cond -> numPred[c] == 0) {
+                printTo(out, ", apex");
+            }
+            if (cond -> dagStart[c + 1] == cond -> dagStart[c]) {
+                printTo(out, ", producer");
+            }
+            printTo(out, ")\n");
         }
+        printTo(out, "\n");
+    }
 
-        if (found) {
-            // Count elements not equal to the extinct index.
-            int oldPreyCount = org -> numPrey;
-            int newPreyCount = 0;
-            for (int j = 0; j < oldPreyCount; j++) {
-                if (org -> prey[j] != index) {
-                    newPreyCount++;
+    // Vore Types, from the maintained producer-prey counts.
+    if (modified) printTo(out, "UPDATED ");
+    printTo(out, "Vore Types:\n");
+    if (numLive > 0) {
+        const char* voreNames[] = {"Producers", "Herbivores", "Omnivores", "Carnivores"};
+        for (int type = 0; type < 4; type++) {
+            printTo(out, "  %s:\n", voreNames[type]);
+            for (int i = 0; i < numOrgs; i++) {
+                if (!orgs[i].extinct && voreType(web, i) == type) {
+                    printTo(out, "    %s\n", names + orgs[i].nameOff);
                 }
             }
+        }
+    }
+    printTo(out, "\n");
+}
 
-            // Handle the new prey array creation.
-            if (newPreyCount == 0) {
-                free(org -> prey);
-                org -> prey = NULL;
-                org -> numPrey = 0;
-            } else {
-                int* newPrey = (int*)malloc(newPreyCount * sizeof(int));
-                if (newPrey == NULL) {
-                    return false; // Memory allocation failed.
-                }
 
-                int k = 0;
-                for (int j = 0; j < oldPreyCount; j++) {
-                    if (org -> prey[j] != index) {
-                        newPrey[k++] = org -> prey[j];
-                    }
-                }
 
-                free(org -> prey);
-                org -> prey = newPrey;
-                org -> numPrey = newPreyCount;
-            }
-        }
+// Fill in the characteristics displayAll() shows, as counts. Returns false
+// if memory runs out.
+bool summarizeWeb(Web* web, WebSummary* summary) {
+    if (!compactWeb(web)) {
+        return false;
+    }
+    int numOrgs = web -> numOrgs;
+    summary -> numOrgs = numOrgs;
+    summary -> numEdges = web -> numEdges;
+    summary -> numApex = 0;
+    summary -> mostPrey = web -> byNumPrey.maxDeg;
+    summary -> numFlexible = 0;
+    summary -> mostPred = web -> byNumPred.maxDeg;
+    summary -> numTastiest = 0;
+    for (int type = 0; type < 4; type++) {
+        summary -> numVores[type] = 0;
+    }
+    for (int i = 0; i < numOrgs; i++) {
+        int numPrey = web -> orgs[i].numPrey;
+        int numPred = web -> links[i].numPred;
+        summary -> numApex += (numPred == 0);
+        summary -> numFlexible += (numPrey > 0 && numPrey == summary -> mostPrey);
+        summary -> numTastiest += (numPred > 0 && numPred == summary -> mostPred);
+        summary -> numVores[voreType(web, i)]++;
+    }
 
-        // Adjust prey indices greater than the extinct index.
-        for (int j = 0; j < org -> numPrey; j++) {
-            if (org -> prey[j] > index) {
-                org -> prey[j]--;
+    // The height of the web and its feeding cycles, as in displayAll().
+    if (!web -> heightsValid) {
+        recomputeHeights(web);
+    }
+    summary -> height = 0;
+    summary -> numCycles = 0;
+    if (web -> heightsValid) {
+        for (int i = 0; i < numOrgs; i++) {
+            if (web -> links[i].height > summary -> height) {
+                summary -> height = web -> links[i].height;
             }
         }
+        return true;
+    }
+    if (!condenseWeb(web)) {
+        return false;
+    }
+    Condensation* cond = &(web -> cond);
+    for (int c = 0; c < cond -> numComps; c++) {
+        if (cond -> height[c] > summary -> height) {
+            summary -> height = cond -> height[c];
+        }
+        summary -> numCycles += (cond -> memberStart[c + 1] - cond -> memberStart[c] > 1);
     }
-
     return true;
 }
 
+// Seconds on a monotonic clock, for timing.
+double secondsNow(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
 
-void freeWeb(Org* web, int numOrgs) {
-
-    // Check if web is NULL (nothing to free).
-    if (web == NULL) {
-        return;
-    }
-
-    // Free each organism's prey array.
-    for (int i = 0; i < numOrgs; i++) {
-        if (web[i].prey != NULL) {
-            free(web[i].prey);
+// One reader's lookup: a random organism of the current view and its prey,
+// none of which may be extinct in the same view. Returns false for a torn
+// snapshot.
+bool readSnapshot(SnapshotPublisher* pub, int slot, uint64_t* pState) {
+    WebView* view = beginRead(pub, slot);
+    bool consistent = true;
+    if (pub -> set.numOrgs > 0) {
+        POrg* org = branchOrg(&(pub -> set), &(view -> branch), (int)(nextRandom(pState) % (uint64_t)pub -> set.numOrgs));
+        for (int j = 0; !org -> extinct && org -> prey != NULL && j < org -> prey -> num; j++) {
+            consistent = consistent && !branchOrg(&(pub -> set), &(view -> branch), org -> prey -> items[j]) -> extinct;
         }
     }
-
-    // Free the web array itself.
-    free(web);
+    endRead(pub, slot);
+    return consistent;
 }
 
-void printWeb(Org* web, int numOrgs) {
-    for (int i = 0; i < numOrgs; i++) {
-        printf("  (%d) %s", i, web[i].name);
-        if (web[i].numPrey > 0) {
-            printf(" eats ");
-            for (int j = 0; j < web[i].numPrey; j++) {
-                if (j > 0) {
-                    printf(", ");
+// Apply BENCHMARK_OPS random extinctions and relations to a published copy of
+// the web, publishing after each one, while every other thread (up to
+// MAX_SNAPSHOT_READERS - 1) keeps reading snapshots. Fills in the rates of
+// both and whether every read saw a consistent snapshot, and returns false if
+// memory runs out.
+bool benchmarkSnapshots(Web* web, uint64_t seed, double* pPublishRate, double* pReadRate, bool* pConsistent) {
+    SnapshotPublisher pub;
+    if (!initPublisher(web, &pub)) {
+        return false;
+    }
+#ifdef _OPENMP
+    int numThreads = omp_get_max_threads();
+    if (numThreads > MAX_SNAPSHOT_READERS) {
+        numThreads = MAX_SNAPSHOT_READERS;
+    }
+#endif
+    atomic_bool done;
+    atomic_init(&done, false);
+    long numReads = 0;
+    int numOps = 0;
+    bool ok = true;
+    bool consistent = true;
+    double start = secondsNow();
+    double writeTime = 0.0;
+
+#ifdef _OPENMP
+    #pragma omp parallel num_threads(numThreads) reduction(+:numReads) reduction(&&:consistent)
+#endif
+    {
+        int slot = 0;
+#ifdef _OPENMP
+        slot = omp_get_thread_num();
+#endif
+        uint64_t state = seed + 2 * (uint64_t)slot + 1;
+        int numOrgs = pub.set.numOrgs;
+        if (slot == 0) {
+            // The writer: extinctions of live organisms and new relations, in turn.
+            for (; numOps < BENCHMARK_OPS && ok && pub.set.branches[0].numLive > 0; numOps++) {
+                int orgInd = (int)(nextRandom(&state) % (uint64_t)numOrgs);
+                if (numOps % 2 == 0) {
+                    while (branchOrg(&(pub.set), &(pub.set.branches[0]), orgInd) -> extinct) {
+                        orgInd = (int)(nextRandom(&state) % (uint64_t)numOrgs);
+                    }
+                    ok = removeBranchOrg(&(pub.set), 0, orgInd);
+                } else {
+                    addBranchRelation(&(pub.set), 0, orgInd, (int)(nextRandom(&state) % (uint64_t)numOrgs));
                 }
-                printf("%s", web[web[i].prey[j]].name);
+                ok = ok && publishWeb(&pub);
+            }
+            writeTime = secondsNow() - start;
+            atomic_store(&done, true);
+        } else {
+            while (!atomic_load(&done)) {
+                consistent = readSnapshot(&pub, slot, &state) && consistent;
+                numReads++;
             }
         }
-        printf("\n");
     }
+
+    freePublisher(&pub);
+    *pPublishRate = numOps / (writeTime + 1e-9);
+    *pReadRate = numReads / (writeTime + 1e-9);
+    *pConsistent = consistent;
+    return ok;
 }
 
+// Time the modifications and the full analysis on generated webs of 1000,
+// 2000, 4000, ... species up to the model's count (the same connectance
+// throughout), printing operations per second and the peak resident memory
+// so far. Each scale times BENCHMARK_OPS relations added between random
+// organisms, organisms added, one displayAll() analysis (printing nothing), and
+// extinctions of random organisms, in that order, so growth faster than the
+// web itself shows up as falling rates. Last come changes published to
+// concurrent snapshot readers (see benchmarkSnapshots()).
+void benchmarkWeb(WebModel* model) {
+    printf("Benchmarking the %s model at connectance %.4f...\n",
+           (model -> kind == 'c') ? "cascade" : "niche", model -> connectance);
+    printf("%9s %10s %10s %12s %12s %12s %10s %12s %12s %9s\n", "species", "relations", "build s",
+           "add rel/s", "add org/s", "remove/s", "analysis s", "publish/s", "reads/s", "peak MB");
+    uint64_t state = 12345;
+    char name[16];
+    for (int numSpecies = 1000; ; numSpecies *= 2) {
+        if (numSpecies > model -> numSpecies) {
+            numSpecies = model -> numSpecies;
+        }
+        WebModel scaled = *model;
+        scaled.numSpecies = numSpecies;
+        Web web;
+        initWeb(&web);
+        double start = secondsNow();
+        bool ok = generateWeb(&web, &scaled, (uint64_t)numSpecies);
+        compactEdges(&web);
+        double buildTime = secondsNow() - start;
+        int numRelations = web.numEdges;
 
-void displayAll(Org* web, int numOrgs, bool modified) {
+        // New relations between random organisms (pairs already related are
+        // drawn again, so the web changes on every timed call).
+        start = secondsNow();
+        int numAddedRels = 0;
+        while (numAddedRels < BENCHMARK_OPS && ok && web.numEdges < (int64_t)numSpecies * (numSpecies - 1)) {
+            int predInd;
+            int preyInd;
+            do {
+                predInd = (int)(nextRandom(&state) % (uint64_t)numSpecies);
+                preyInd = (int)(nextRandom(&state) % (uint64_t)numSpecies);
+            } while (predInd == preyInd || hasRelation(&web, predInd, preyInd));
+            ok = addRelationToWeb(&web, predInd, preyInd);
+            numAddedRels++;
+        }
+        double addRelTime = secondsNow() - start;
 
-    if (modified) printf("UPDATED ");
-    printf("Food Web Predators & Prey:\n");
-    printWeb(web,numOrgs);
-    printf("\n");
+        start = secondsNow();
+        for (int k = 0; k < BENCHMARK_OPS && ok; k++) {
+            sprintf(name, "n%d", k);
+            ok = addOrgToWeb(&web, name);
+        }
+        double addOrgTime = secondsNow() - start;
 
-    // Apex Predators: not eaten by any other.
-    if (modified) printf("UPDATED ");
-    printf("Apex Predators:\n");
-    if (numOrgs > 0) {
-        bool* isPrey = (bool*)calloc(numOrgs, sizeof(bool));
-        for (int i = 0; i < numOrgs; i++) {
-            for (int j = 0; j < web[i].numPrey; j++) {
-                int preyIndex = web[i].prey[j];
-                isPrey[preyIndex] = true;
-            }
+        // The full analysis behind displayAll(), without formatting its report.
+        start = secondsNow();
+        displayAll(&web, false, NULL);
+        double displayTime = secondsNow() - start;
+
+        start = secondsNow();
+        int numRemoved = 0;
+        while (numRemoved < BENCHMARK_OPS && ok && web.numExtinct < web.numOrgs) {
+            int extInd;
+            do {
+                extInd = (int)(nextRandom(&state) % (uint64_t)web.numOrgs);
+            } while (web.orgs[extInd].extinct);
+            ok = removeOrgFromWeb(&web, extInd);
+            numRemoved++;
         }
-        for (int i = 0; i < numOrgs; i++) {
-            if (!isPrey[i]) {
-                printf("  %s\n", web[i].name);
-            }
+        double removeTime = secondsNow() - start;
+
+        double publishRate = 0.0;
+        double readRate = 0.0;
+        bool consistent = true;
+        ok = ok && benchmarkSnapshots(&web, (uint64_t)numSpecies, &publishRate, &readRate, &consistent);
+        freeWeb(&web);
+
+        if (!ok) {
+            printf("Ran out of memory at %d species.\n", numSpecies);
+            break;
+        }
+        if (!consistent) {
+            printf("A snapshot reader saw a torn web at %d species.\n", numSpecies);
+        }
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        printf("%9d %10d %10.3f %12.0f %12.0f %12.0f %10.3f %12.0f %12.0f %9.1f\n", numSpecies, numRelations, buildTime,
+               numAddedRels / (addRelTime + 1e-9), BENCHMARK_OPS / (addOrgTime + 1e-9),
+               numRemoved / (removeTime + 1e-9), displayTime, publishRate, readRate, usage.ru_maxrss / 1024.0);
+        if (numSpecies == model -> numSpecies) {
+            break;
         }
-        free(isPrey);
     }
     printf("\n");
+}
 
-    // Producers: eat nothing.
-    if (modified) printf("UPDATED ");
-    printf("Producers:\n");
-    for (int i = 0; i < numOrgs; i++) {
-        if (web[i].numPrey == 0) {
-            printf("  %s\n", web[i].name);
+
+// Add a copy of a path to a growing list of paths.
+bool addPath(char*** pPaths, int* pNumPaths, int* pCapPaths, const char* path) {
+    if (*pNumPaths == *pCapPaths) {
+        int newCap = (*pCapPaths > 0) ? 2 * *pCapPaths : 16;
+        char** newPaths = (char**)realloc(*pPaths, newCap * sizeof(char*));
+        if (newPaths == NULL) {
+            return false; // Memory allocation failed.
         }
+        *pPaths = newPaths;
+        *pCapPaths = newCap;
     }
-    printf("\n");
+    char* copy = (char*)malloc(strlen(path) + 1);
+    if (copy == NULL) {
+        return false; // Memory allocation failed.
+    }
+    strcpy(copy, path);
+    (*pPaths)[(*pNumPaths)++] = copy;
+    return true;
+}
 
-    // Most Flexible Eaters: most prey.
-    if (modified) printf("UPDATED ");
-    printf("Most Flexible Eaters:\n");
-    if (numOrgs > 0) {
-        int maxPrey = 0;
-        for (int i = 0; i < numOrgs; i++) {
-            if (web[i].numPrey > maxPrey) {
-                maxPrey = web[i].numPrey;
-            }
-        }
-        if (maxPrey > 0) {
-            for (int i = 0 ; i < numOrgs; i++) {
-                if (web[i].numPrey == maxPrey) {
-                    printf("  %s\n", web[i].name);
-                }
-            }
-        }
+int comparePaths(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+// List the web files named by a directory (its regular files not starting
+// with '.', sorted by name) or by a manifest (one path per line; blank lines
+// and lines starting with '#' are skipped). Returns false if the input
+// cannot be read or memory runs out.
+bool listWebFiles(const char* input, char*** pPaths, int* pNumPaths) {
+    char** paths = NULL;
+    int numPaths = 0;
+    int capPaths = 0;
+    bool ok = true;
+    struct stat info;
+    if (stat(input, &info) != 0) {
+        return false;
     }
-    printf("\n");
 
-    // Tastiest Food: most eaten.
-    if (modified) printf("UPDATED ");
-    printf("Tastiest Food:\n");
-    if (numOrgs > 0) {
-        int* eatenCount = (int*)calloc(numOrgs, sizeof(int));
-        for (int i = 0; i < numOrgs; i++) {
-            for (int j = 0;j < web[i].numPrey; j++) {
-                int preyIndex = web[i].prey[j];
-                eatenCount[preyIndex]++;
-            }
+    if (S_ISDIR(info.st_mode)) {
+        DIR* dir = opendir(input);
+        if (dir == NULL) {
+            return false;
         }
-        int maxEaten = 0;
-        for (int i = 0; i < numOrgs; i++) {
-            if (eatenCount[i] > maxEaten) {
-                maxEaten = eatenCount[i];
+        char* path = NULL;
+        size_t capPath = 0;
+        struct dirent* entry;
+        while (ok && (entry = readdir(dir)) != NULL) {
+            if (entry -> d_name[0] == '.') {
+                continue;
             }
-        }
-        if (maxEaten > 0) {
-            for (int i = 0; i < numOrgs; i++) {
-                if (eatenCount[i] == maxEaten) {
-                    printf("  %s\n", web[i].name);
+            size_t len = strlen(input) + strlen(entry -> d_name) + 2;
+            if (len > capPath) {
+                char* newPath = (char*)realloc(path, len);
+                ok = (newPath != NULL);
+                path = ok ? newPath : path;
+                capPath = ok ? len : capPath;
+            }
+            if (ok) {
+                sprintf(path, "%s/%s", input, entry -> d_name);
+                if (stat(path, &info) == 0 && S_ISREG(info.st_mode)) {
+                    ok = addPath(&paths, &numPaths, &capPaths, path);
                 }
             }
         }
-        free(eatenCount);
-    }
-    printf("\n");
-
-    // Food Web Height.
-    if (modified) printf("UPDATED ");
-    printf("Food Web Heights:\n");
-    if (numOrgs > 0) {
-        int* heights = (int*)malloc(numOrgs * sizeof(int));
-        for (int i = 0; i < numOrgs; i++) {
-            heights[i] = 0;
+        closedir(dir);
+        free(path);
+        if (ok) {
+            qsort(paths, numPaths, sizeof(char*), comparePaths);
         }
-        bool changed;
-        do {
-            changed = false;
-            for (int i = 0; i < numOrgs; i++) {
-                if (web[i].numPrey == 0) continue;
-                int maxHeight = -1;
-                for (int j = 0; j < web[i].numPrey; j++) {
-                    int preyIndex = web[i].prey[j];
-                    if (heights[preyIndex] > maxHeight) {
-                        maxHeight = heights[preyIndex];
-                    }
-                }
-                int newHeight = maxHeight + 1;
-                if (newHeight > heights[i]) {
-                    heights[i] = newHeight;
-                    changed = true;
-                }
+    } else {
+        char* data;
+        size_t size;
+        bool mapped;
+        if (!mapFile(input, &data, &size, &mapped)) {
+            return false;
+        }
+        char* line = (char*)malloc(size + 1);
+        ok = (line != NULL);
+        for (size_t pos = 0; ok && pos < size; pos++) {
+            size_t len = 0;
+            while (pos < size && data[pos] != '\n') {
+                line[len++] = data[pos++];
+            }
+            while (len > 0 && isspace((unsigned char)line[len - 1])) {
+                len--; // Trailing blanks and '\r'.
+            }
+            line[len] = '\0';
+            if (len > 0 && line[0] != '#') {
+                ok = addPath(&paths, &numPaths, &capPaths, line);
             }
-        } while (changed);
-        for (int i = 0; i < numOrgs; i++) {
-            printf("  %s: %d\n", web[i].name, heights[i]);
         }
-        free(heights);
+        free(line);
+        unmapFile(data, size, mapped);
     }
-    printf("\n");
 
-    // Vore Types
-    if (modified) printf("UPDATED ");
-    printf("Vore Types:\n");
-    if (numOrgs > 0) {
-        bool* isProducer = (bool*)malloc(numOrgs * sizeof(bool));
-        for (int i = 0; i < numOrgs; i++) {
-            isProducer[i] = (web[i].numPrey == 0);
+    if (!ok) {
+        for (int k = 0; k < numPaths; k++) {
+            free(paths[k]);
         }
+        free(paths);
+        return false;
+    }
+    *pPaths = paths;
+    *pNumPaths = numPaths;
+    return true;
+}
 
-        int* categories = (int*)malloc(numOrgs * sizeof(int));
-
-        for (int i = 0; i < numOrgs; i++) {
-            if (isProducer[i]) {
-                categories[i] = 0;
-            } else {
-                int preyProducers = 0, preyNonProducers = 0;
-                for (int j = 0; j < web[i].numPrey; j++) {
-                    int preyIndex = web[i].prey[j];
-                    if (isProducer[preyIndex]) {
-                        preyProducers++;
-                    } else {
-                        preyNonProducers++;
-                    }
-                }
-                if (preyProducers > 0 && preyNonProducers == 0) {
-                    categories[i] = 1;
-                } else if (preyNonProducers > 0 && preyProducers == 0) {
-                    categories[i] = 3;
-                } else {
-                    categories[i] = 2;
-                }
-            }
-        }
-        printf("  Producers:\n");
-        for (int i = 0; i < numOrgs; i++) {
-            if (categories[i] == 0) {
-                printf("    %s\n", web[i].name);
-            }
+// Write a CSV field, quoted if it holds a comma, quote or line break.
+void writeCsvField(FILE* out, const char* field) {
+    if (strpbrk(field, ",\"\r\n") == NULL) {
+        fputs(field, out);
+        return;
+    }
+    fputc('"', out);
+    for (const char* c = field; *c != '\0'; c++) {
+        if (*c == '"') {
+            fputc('"', out);
         }
+        fputc(*c, out);
+    }
+    fputc('"', out);
+}
 
-        printf("  Herbivores:\n");
-        for (int i = 0; i < numOrgs; i++) {
-            if (categories[i] == 1) {
-                printf("    %s\n", web[i].name);
-            }
+// Analyze every web file (edge lists, as for -i) that input names, see
+// listWebFiles(), and write one CSV row per web to resultsPath in input
+// order. The webs are spread over a pool of workers (the OpenMP threads), and
+// each worker keeps one web whose memory it reuses for every file it takes.
+// pNumFailed receives the number of webs that could not be read. Returns the
+// number of webs, or -1 if the input or the results file cannot be opened
+// or memory runs out.
+int analyzeWebFiles(const char* input, const char* resultsPath, int* pNumFailed) {
+    char** paths = NULL;
+    int numPaths = 0;
+    if (!listWebFiles(input, &paths, &numPaths)) {
+        return -1;
+    }
+    WebSummary* summaries = (WebSummary*)malloc(((size_t)numPaths + 1) * sizeof(WebSummary));
+    FILE* out = (summaries != NULL) ? fopen(resultsPath, "w") : NULL;
+    if (out == NULL) {
+        for (int k = 0; k < numPaths; k++) {
+            free(paths[k]);
         }
+        free(paths);
+        free(summaries);
+        return -1;
+    }
 
-        printf("  Omnivores:\n");
-        for (int i = 0; i < numOrgs; i++) {
-            if (categories[i] == 2) {
-                printf("    %s\n", web[i].name);
+#ifdef _OPENMP
+    #pragma omp parallel
+#endif
+    {
+        Web web; // This worker's arena.
+        initWeb(&web);
+#ifdef _OPENMP
+        #pragma omp for schedule(dynamic, 1)
+#endif
+        for (int k = 0; k < numPaths; k++) {
+            int numSkipped = 0;
+            clearWeb(&web);
+            summaries[k].ok = importWeb(&web, paths[k], &numSkipped) && summarizeWeb(&web, &summaries[k]);
+            summaries[k].numSkipped = numSkipped;
+            if (!summaries[k].ok) {
+                freeWeb(&web); // Start the next one from a clean web.
             }
         }
+        freeWeb(&web);
+    }
 
-        printf("  Carnivores:\n");
-        for (int i = 0; i < numOrgs; i++) {
-            if (categories[i] == 3) {
-                printf("    %s\n", web[i].name);
-            }
+    int numFailed = 0;
+    fprintf(out, "file,status,organisms,relations,skipped_relations,apex_predators,producers,herbivores,"
+                 "omnivores,carnivores,most_prey,most_flexible_eaters,most_predators,tastiest_foods,"
+                 "height,feeding_cycles\n");
+    for (int k = 0; k < numPaths; k++) {
+        WebSummary* summary = &(summaries[k]);
+        writeCsvField(out, paths[k]);
+        if (!summary -> ok) {
+            fprintf(out, ",unreadable,,,,,,,,,,,,,,\n");
+            numFailed++;
+        } else {
+            fprintf(out, ",ok,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n", summary -> numOrgs,
+                    summary -> numEdges, summary -> numSkipped, summary -> numApex, summary -> numVores[0],
+                    summary -> numVores[1], summary -> numVores[2], summary -> numVores[3], summary -> mostPrey,
+                    summary -> numFlexible, summary -> mostPred, summary -> numTastiest, summary -> height,
+                    summary -> numCycles);
         }
-        free(isProducer);
-        free(categories);
+        free(paths[k]);
     }
-    printf("\n");
+    free(paths);
+    free(summaries);
+    bool written = (fclose(out) == 0);
+    *pNumFailed = numFailed;
+    return written ? numPaths : -1;
 }
 
-
-
-bool setModes(int argc, char* argv[], bool* pBasicMode, bool* pDebugMode, bool* pQuietMode) {
+bool setModes(int argc, char* argv[], bool* pBasicMode, bool* pDebugMode, bool* pQuietMode,
+              char** pImportFile, char** pLoadFile, char** pSaveFile, char** pQueryFile,
+              WebModel* pModel, bool* pBenchMode, char** pBatchInput, char** pBatchResults) {
     // Initialize all modes to false.
     *pBasicMode = false;
     *pDebugMode = false;
     *pQuietMode = false;
+    *pImportFile = NULL;
+    *pLoadFile = NULL;
+    *pSaveFile = NULL;
+    *pQueryFile = NULL;
+    pModel -> kind = 0;
+    *pBenchMode = false;
+    *pBatchInput = NULL;
+    *pBatchResults = NULL;
 
     // Track if each node has been set to detect duplicates.
     bool basicSet = false;
@@ -471,15 +4824,101 @@ bool setModes(int argc, char* argv[], bool* pBasicMode, bool* pDebugMode, bool*
             }
             *pQuietMode = true;
             quietSet = true;
+        } else if (modeChar == 'i') {
+            if (*pImportFile != NULL || i + 1 >= argc) {
+                return false; // Duplicate import argument or missing file name.
+            }
+            *pImportFile = argv[++i];
+        } else if (modeChar == 'l') {
+            if (*pLoadFile != NULL || i + 1 >= argc) {
+                return false; // Duplicate load argument or missing file name.
+            }
+            *pLoadFile = argv[++i];
+        } else if (modeChar == 's') {
+            if (*pSaveFile != NULL || i + 1 >= argc) {
+                return false; // Duplicate save argument or missing file name.
+            }
+            *pSaveFile = argv[++i];
+        } else if (modeChar == 'e') {
+            if (*pQueryFile != NULL || i + 1 >= argc) {
+                return false; // Duplicate query argument or missing file name.
+            }
+            *pQueryFile = argv[++i];
+        } else if (modeChar == 'g') {
+            if (pModel -> kind != 0 || i + 3 >= argc) {
+                return false; // Duplicate model argument or missing parameters.
+            }
+            char* model = argv[++i];
+            char* speciesEnd;
+            char* connectanceEnd;
+            long numSpecies = strtol(argv[++i], &speciesEnd, 10);
+            double connectance = strtod(argv[++i], &connectanceEnd);
+            if ((strcmp(model, "cascade") != 0 && strcmp(model, "niche") != 0) ||
+                *speciesEnd != '\0' || numSpecies < 1 || numSpecies > INT32_MAX / 2 ||
+                *connectanceEnd != '\0' || !(connectance > 0.0 && connectance < 0.5)) {
+                return false; // Unknown model or parameters out of range.
+            }
+            pModel -> kind = model[0];
+            pModel -> numSpecies = (int)numSpecies;
+            pModel -> connectance = connectance;
+        } else if (modeChar == 'p') {
+            if (*pBenchMode) {
+                return false; // Duplicate benchmark argument.
+            }
+            *pBenchMode = true;
+        } else if (modeChar == 'a') {
+            if (*pBatchInput != NULL || i + 2 >= argc) {
+                return false; // Duplicate batch argument or missing file names.
+            }
+            *pBatchInput = argv[++i];
+            *pBatchResults = argv[++i];
         } else {
             return false; // Invalid mode character
         }
     }
 
+    // The initial web comes from at most one file or model, and a batch
+    // analysis reads its own webs instead.
+    if ((*pImportFile != NULL) + (*pLoadFile != NULL) + (pModel -> kind != 0) + (*pBatchInput != NULL) > 1 ||
+        (*pBatchInput != NULL && *pBenchMode)) {
+        return false;
+    }
+
     return true; // All Arguments Processed Successfully.
 }
 
 
+// Read the next whitespace-delimited word from stdin into a buffer that grows
+// as needed, so organism names have no fixed length limit.
+bool readWord(char** pWord, int* pCapWord) {
+    int c = getchar();
+    while (c != EOF && isspace(c)) {
+        c = getchar();
+    }
+    if (c == EOF) {
+        return false; // No more input.
+    }
+
+    int len = 0;
+    while (c != EOF && !isspace(c)) {
+        if (len + 1 >= *pCapWord) {
+            int newCap = (*pCapWord > 0) ? 2 * *pCapWord : 32;
+            char* newWord = (char*)realloc(*pWord, newCap);
+            if (newWord == NULL) {
+                return false; // Memory allocation failed.
+            }
+            *pWord = newWord;
+            *pCapWord = newCap;
+        }
+        (*pWord)[len++] = (char)c;
+        c = getchar();
+    }
+    ungetc(c, stdin);
+    (*pWord)[len] = '\0';
+    return true;
+}
+
+
 void printONorOFF(bool mode) {
     if (mode) {
         printf("ON\n");
@@ -489,14 +4928,26 @@ void printONorOFF(bool mode) {
 }
 
 
+// test.c includes this file with FOOD_WEB_NO_MAIN defined to test the
+// functions above without the interactive program.
+#ifndef FOOD_WEB_NO_MAIN
 int main(int argc, char* argv[]) {
     // Initialize program modes from command-line arguments.
     bool basicMode = false; // Basic Mode Flag (No Modifications)
     bool debugMode = false; // Debug Mode Flag (Show Intermediate Steps)
     bool quietMode = false; // Quiet Mode Flag (Suppress Prompts)
+    char* importFile = NULL; // Edge-List File to Load Instead of Prompting (-i <file>)
+    char* loadFile = NULL;   // Snapshot to Map Instead of Prompting (-l <file>)
+    char* saveFile = NULL;   // Snapshot to Write Before Quitting (-s <file>)
+    char* queryFile = NULL;  // "Ultimately Eats" Queries to Answer in Bulk (-e <file>)
+    WebModel model;          // Synthetic Web to Start From (-g <model> <species> <connectance>)
+    bool benchMode = false;  // Benchmark Mode Flag (Time Operations on Generated Webs, -p)
+    char* batchInput = NULL;   // Directory or Manifest of Webs to Analyze in Bulk (-a <input> <results>)
+    char* batchResults = NULL; // CSV File Receiving One Row per Analyzed Web
 
     // Process Command-line Arguments
-    if (!setModes(argc, argv, &basicMode, &debugMode, &quietMode)) {
+    if (!setModes(argc, argv, &basicMode, &debugMode, &quietMode, &importFile, &loadFile, &saveFile, &queryFile,
+                  &model, &benchMode, &batchInput, &batchResults)) {
         printf("Invalid command-line argument. Terminating program...\n");
         return 1;
     }
@@ -511,59 +4962,122 @@ int main(int argc, char* argv[]) {
     printONorOFF(quietMode);
     printf("\n");
 
+    // Benchmark Mode: Time Generated Webs Instead of Running the Application.
+    if (benchMode) {
+        if (model.kind == 0) { // Default: niche webs of up to 16000 species.
+            model.kind = 'n';
+            model.numSpecies = 16000;
+            model.connectance = 0.01;
+        }
+        benchmarkWeb(&model);
+        return 0;
+    }
+
+    // Batch Mode: Analyze Many Webs Instead of Running the Application.
+    if (batchInput != NULL) {
+        int numFailed = 0;
+        int numWebs = analyzeWebFiles(batchInput, batchResults, &numFailed);
+        if (numWebs < 0) {
+            printf("Could not analyze the food webs in %s. Terminating program...\n", batchInput);
+            return 1;
+        }
+        printf("Analyzed %d food webs from %s into %s (%d could not be read).\n", numWebs, batchInput,
+               batchResults, numFailed);
+        return 0;
+    }
+
     // Initialize Food Web Data Structure
-    int numOrgs = 0; // Number of Organisms in the Web.
+    Web web; // Dynamic Array of Organisms and its Capacity.
+    initWeb(&web);
 
     // Phase 1: Build Initial Food Web
     printf("Welcome to the Food Web Application\n\n");
     printf("--------------------------------\n\n");
 
-    Org* web = NULL; // Dynamic Array of Organisms.
-
-    // Get Organisms Names Until User Enters "Done".
-    printf("Building the initial food web...\n");
-    if (!quietMode) printf("Enter the name for an organism in the web (or enter DONE): ");
-    char tempName[20] = "";
-    scanf("%s",tempName);
-    if (!quietMode) printf("\n");
-    while (strcmp(tempName,"DONE") != 0) {
-        addOrgToWeb(&web,&numOrgs,tempName); // Add Organism to Web.
-        if (debugMode) {    // Debug Output if Enabled.
-            printf("DEBUG MODE - added an organism:\n");
-            printWeb(web,numOrgs);
-            printf("\n");
+    char* tempName = NULL; // Growable Buffer for Names Read from Input.
+    int capTempName = 0;
+    int predInd, preyInd; // Relation Indices Read from Input.
+    if (importFile != NULL) {
+        // Phases 1 and 2 in Bulk: Load Organisms and Relations from the File.
+        printf("Building the initial food web...\n");
+        int numSkipped = 0;
+        if (!importWeb(&web, importFile, &numSkipped)) {
+            printf("Could not import the food web from %s. Terminating program...\n", importFile);
+            freeWeb(&web);
+            return 1;
+        }
+        printf("Imported %d organisms and %d relations from %s", web.numOrgs, web.numEdges, importFile);
+        printf(" (%d duplicate or self relations skipped).\n", numSkipped);
+        printf("\n");
+    } else if (model.kind != 0) {
+        // Phases 1 and 2 from a Model: Generate Organisms and Relations.
+        printf("Building the initial food web...\n");
+        if (!generateWeb(&web, &model, 1)) {
+            printf("Could not generate the food web. Terminating program...\n");
+            freeWeb(&web);
+            return 1;
         }
+        compactEdges(&web);
+        printf("Generated %d organisms and %d relations from the %s model.\n", web.numOrgs, web.numEdges,
+               (model.kind == 'c') ? "cascade" : "niche");
+        printf("\n");
+    } else if (loadFile != NULL) {
+        // Phases 1 and 2 from a Snapshot: Map the Saved Web As Is.
+        printf("Building the initial food web...\n");
+        if (!loadWeb(&web, loadFile)) {
+            printf("Could not load a food web snapshot from %s. Terminating program...\n", loadFile);
+            freeWeb(&web);
+            return 1;
+        }
+        printf("Loaded %d organisms and %d relations from %s.\n", web.numOrgs, web.numEdges, loadFile);
+        printf("\n");
+    } else {
+        // Get Organisms Names Until User Enters "Done".
+        printf("Building the initial food web...\n");
         if (!quietMode) printf("Enter the name for an organism in the web (or enter DONE): ");
-        scanf("%s",tempName);
+        bool gotName = readWord(&tempName,&capTempName);
         if (!quietMode) printf("\n");
-    }
-    if (!quietMode) printf("\n");
-
-    // Phase 2: Establish Predator-Prey Relationships.
-    if (!quietMode) printf("Enter the pair of indices for a predator/prey relation.\n");
-    if (!quietMode) printf("Enter any invalid index when done (-1 2, 0 -9, 3 3, etc.).\n");
-    if (!quietMode) printf("The format is <predator index> <prey index>: ");
-
-    int predInd, preyInd;
-    scanf("%d %d",&predInd, &preyInd);
-    if (!quietMode) printf("\n");
-
-    // Process Relationships Until Invalid Input.
-    while (predInd >= 0 && preyInd >= 0 && predInd < numOrgs &&  preyInd < numOrgs && predInd != preyInd) {
-        addRelationToWeb(web,numOrgs,predInd,preyInd); // Add Relationship.
-        if (debugMode) {
-            printf("DEBUG MODE - added a relation:\n");
-            printWeb(web,numOrgs);
-            printf("\n");
+        while (gotName && strcmp(tempName,"DONE") != 0) {
+            addOrgToWeb(&web,tempName); // Add Organism to Web.
+            if (debugMode) {    // Debug Output if Enabled.
+                printf("DEBUG MODE - added an organism:\n");
+                printWeb(&web, stdout);
+                printf("\n");
+            }
+            if (!quietMode) printf("Enter the name for an organism in the web (or enter DONE): ");
+            gotName = readWord(&tempName,&capTempName);
+            if (!quietMode) printf("\n");
         }
+        if (!quietMode) printf("\n");
+
+        // Phase 2: Establish Predator-Prey Relationships.
         if (!quietMode) printf("Enter the pair of indices for a predator/prey relation.\n");
         if (!quietMode) printf("Enter any invalid index when done (-1 2, 0 -9, 3 3, etc.).\n");
         if (!quietMode) printf("The format is <predator index> <prey index>: ");
 
         scanf("%d %d",&predInd, &preyInd);
         if (!quietMode) printf("\n");
+
+        // Process Relationships Until Invalid Input.
+        while (predInd >= 0 && preyInd >= 0 && predInd < web.numOrgs &&  preyInd < web.numOrgs && predInd != preyInd) {
+            addRelationToWeb(&web,predInd,preyInd); // Add Relationship.
+            if (debugMode) {
+                printf("DEBUG MODE - added a relation:\n");
+                printWeb(&web, stdout);
+                printf("\n");
+            }
+            if (!quietMode) printf("Enter the pair of indices for a predator/prey relation.\n");
+            if (!quietMode) printf("Enter any invalid index when done (-1 2, 0 -9, 3 3, etc.).\n");
+            if (!quietMode) printf("The format is <predator index> <prey index>: ");
+
+            scanf("%d %d",&predInd, &preyInd);
+            if (!quietMode) printf("\n");
+        }
+        printf("\n");
+
+        // Pack the relations into plain CSR order before analyzing them.
+        compactEdges(&web);
     }
-    printf("\n");
 
     printf("--------------------------------\n\n");
 
@@ -571,7 +5085,18 @@ int main(int argc, char* argv[]) {
     printf("Initial food web complete.\n");
     printf("Displaying characteristics for the initial food web...\n");
 
-    displayAll(web,numOrgs,false); // Show Initial Analysis.
+    displayAll(&web, false, stdout); // Show Initial Analysis.
+
+    // Answer Bulk Reachability Queries if Requested.
+    if (queryFile != NULL) {
+        printf("Answering reachability queries from %s...\n", queryFile);
+        int numUnknown = 0;
+        if (answerQueryFile(&web, queryFile, &numUnknown)) {
+            printf("Skipped %d queries naming unknown organisms.\n\n", numUnknown);
+        } else {
+            printf("Could not answer the queries in %s.\n\n", queryFile);
+        }
+    }
 
     // Phase 4: Interactive Modification (If not in Basic Mode).
     if (!basicMode) {
@@ -584,28 +5109,38 @@ int main(int argc, char* argv[]) {
                 printf("Web modification options:\n");
                 printf("   o = add a new organism (expansion)\n");
                 printf("   r = add a new predator/prey relation (supplementation)\n");
+                printf("   R = add a new predator/prey relation by organism names\n");
                 printf("   x = remove an organism (extinction)\n");
+                printf("   X = remove an organism by name\n");
+                printf("   b = apply a batch of modifications\n");
+                printf("   k = rank keystone species by knockout\n");
+                printf("   t = display fractional trophic levels\n");
+                printf("   e = check whether one organism ultimately eats another\n");
+                printf("   w = explore what-if scenarios in branches of the web\n");
+                printf("   c = count food chains from producers to apex predators\n");
+                printf("   m = simulate population dynamics (Lotka-Volterra)\n");
                 printf("   p = print the updated food web\n");
                 printf("   d = display ALL characteristics for the updated food web\n");
                 printf("   q = quit\n");
-                printf("Enter a character (o, r, x, p, d, or q): ");
+                printf("Enter a character (o, r, R, x, X, b, k, t, e, w, c, m, p, d, or q): ");
             }
             scanf(" %c", &opt);
             if (!quietMode) printf("\n\n");
 
             // Handle User Selection.
             if (opt == 'o') { // Add Organism.
-                char newName[20];
                 if (!quietMode) printf("EXPANSION - enter the name for the new organism: ");
-                scanf("%s",newName);
+                bool gotNewName = readWord(&tempName,&capTempName);
                 if (!quietMode) printf("\n");
-                printf("Species Expansion: %s\n", newName);
-                addOrgToWeb(&web,&numOrgs,newName);
+                if (gotNewName) {
+                    printf("Species Expansion: %s\n", tempName);
+                    addOrgToWeb(&web,tempName);
+                }
                 printf("\n");
 
                 if (debugMode) {
                     printf("DEBUG MODE - added an organism:\n");
-                    printWeb(web,numOrgs);
+                    printWeb(&web, stdout);
                     printf("\n");
                 }
 
@@ -614,9 +5149,10 @@ int main(int argc, char* argv[]) {
                 if (!quietMode) printf("EXTINCTION - enter the index for the extinct organism: ");
                 scanf("%d",&extInd);
                 if (!quietMode) printf("\n");
-                if (extInd >= 0 && extInd < numOrgs) {
-                    printf("Species Extinction: %s\n", web[extInd].name);
-                    removeOrgFromWeb(&web,&numOrgs,extInd);
+                extInd = selectLiveOrg(&web,extInd); // Typed indices skip tombstones.
+                if (extInd >= 0) {
+                    printf("Species Extinction: %s\n", orgName(&web,extInd));
+                    removeOrgFromWeb(&web,extInd);
                 } else {
                     printf("Invalid index for species extinction\n");
                 }
@@ -624,7 +5160,7 @@ int main(int argc, char* argv[]) {
 
                 if (debugMode) {
                     printf("DEBUG MODE - removed an organism:\n");
-                    printWeb(web,numOrgs);
+                    printWeb(&web, stdout);
                     printf("\n");
                 }
 
@@ -633,25 +5169,268 @@ int main(int argc, char* argv[]) {
                 if (!quietMode) printf("The format is <predator index> <prey index>: ");
                 scanf("%d %d",&predInd, &preyInd);
                 if (!quietMode) printf("\n");
+                predInd = selectLiveOrg(&web,predInd); // Typed indices skip tombstones.
+                preyInd = selectLiveOrg(&web,preyInd);
+
+                if (addRelationToWeb(&web,predInd,preyInd)) {
+                    printf("New Food Source: %s eats %s\n", orgName(&web,predInd), orgName(&web,preyInd));
+                }
+                printf("\n");
+                if (debugMode) {
+                    printf("DEBUG MODE - added a relation:\n");
+                    printWeb(&web, stdout);
+                    printf("\n");
+                }
+
+            } else if (opt == 'R') { // Add Relation by Names
+                if (!quietMode) printf("SUPPLEMENTATION - enter the pair of names for the new predator/prey relation.\n");
+                if (!quietMode) printf("The format is <predator name> <prey name>: ");
+                predInd = readWord(&tempName,&capTempName) ? findOrgByName(&web,tempName) : -1;
+                preyInd = readWord(&tempName,&capTempName) ? findOrgByName(&web,tempName) : -1;
+                if (!quietMode) printf("\n");
 
-                if (addRelationToWeb(web,numOrgs,predInd,preyInd)) {
-                    printf("New Food Source: %s eats %s\n", web[predInd].name, web[preyInd].name);
+                if (predInd < 0 || preyInd < 0) {
+                    printf("Unknown predator and/or prey name. No relation added to the food web.\n");
+                } else if (addRelationToWeb(&web,predInd,preyInd)) {
+                    printf("New Food Source: %s eats %s\n", orgName(&web,predInd), orgName(&web,preyInd));
                 }
                 printf("\n");
                 if (debugMode) {
                     printf("DEBUG MODE - added a relation:\n");
-                    printWeb(web,numOrgs);
+                    printWeb(&web, stdout);
+                    printf("\n");
+                }
+
+            } else if (opt == 'X') { // Remove Organism by Name
+                if (!quietMode) printf("EXTINCTION - enter the name for the extinct organism: ");
+                int extInd = readWord(&tempName,&capTempName) ? findOrgByName(&web,tempName) : -1;
+                if (!quietMode) printf("\n");
+                if (extInd >= 0) {
+                    printf("Species Extinction: %s\n", orgName(&web,extInd));
+                    removeOrgFromWeb(&web,extInd);
+                } else {
+                    printf("Invalid name for species extinction\n");
+                }
+                printf("\n");
+
+                if (debugMode) {
+                    printf("DEBUG MODE - removed an organism:\n");
+                    printWeb(&web, stdout);
+                    printf("\n");
+                }
+
+            } else if (opt == 'b') { // Apply a Batch of Modifications
+                compactWeb(&web); // Indices typed by the user have no gaps.
+                if (!quietMode) printf("BATCH - enter modifications as o <name>, r <predator index> <prey index>,\n");
+                if (!quietMode) printf("R <predator name> <prey name>, x <index> or X <name>, then end: ");
+                WebBatch batch;
+                initBatch(&batch);
+                bool gotOp = readWord(&tempName,&capTempName);
+                while (gotOp && strcmp(tempName,"end") != 0) {
+                    char kind = (strlen(tempName) == 1) ? tempName[0] : '?';
+                    int args[2] = {-1, -1};
+                    bool gotArgs = true;
+                    if (kind == 'r') {
+                        gotArgs = (scanf("%d %d",&args[0],&args[1]) == 2);
+                    } else if (kind == 'x') {
+                        gotArgs = (scanf("%d",&args[0]) == 1);
+                    } else if (kind == 'o' || kind == 'R' || kind == 'X') {
+                        for (int k = 0; k < ((kind == 'R') ? 2 : 1) && gotArgs; k++) {
+                            gotArgs = readWord(&tempName,&capTempName);
+                            args[k] = gotArgs ? addNameToBatch(&batch,tempName) : -1;
+                        }
+                    } else {
+                        printf("Invalid batch modification: %s\n", tempName);
+                        gotArgs = false;
+                    }
+                    if (gotArgs) {
+                        addOpToBatch(&batch,kind,args[0],args[1]);
+                    }
+                    gotOp = readWord(&tempName,&capTempName);
+                }
+                if (!quietMode) printf("\n");
+                int numRejected = 0;
+                if (applyBatch(&web,&batch,&numRejected)) {
+                    printf("Batch Modification: %d applied, %d rejected\n", batch.numOps - numRejected, numRejected);
+                }
+                printf("\n");
+                freeBatch(&batch);
+
+                if (debugMode) {
+                    printf("DEBUG MODE - applied a batch:\n");
+                    printWeb(&web, stdout);
+                    printf("\n");
+                }
+
+            } else if (opt == 'k') { // Rank Keystone Species
+                printf("Keystone Species (secondary extinctions if removed):\n");
+                int numRanked = rankKeystones(&web);
+                int* numLost = web.work;
+                int* ranking = web.work + web.numOrgs;
+                for (int k = 0; k < numRanked; k++) {
+                    printf("  %s: %d\n", orgName(&web,ranking[k]), numLost[ranking[k]]);
+                }
+                printf("\n");
+
+            } else if (opt == 't') { // Fractional Trophic Levels
+                printf("Fractional Trophic Levels:\n");
+                if (computeTrophicLevels(&web)) {
+                    for (int i = 0; i < web.numOrgs; i++) {
+                        if (web.levels[i] < 0.0) {
+                            printf("  %s: none (feeds on a cycle without producers)\n", orgName(&web,i));
+                        } else {
+                            printf("  %s: %.3f\n", orgName(&web,i), web.levels[i]);
+                        }
+                    }
+                } else {
+                    printf("  Could not compute the trophic levels.\n");
+                }
+                printf("\n");
+
+            } else if (opt == 'e') { // Reachability Query by Names
+                compactWeb(&web); // Names are resolved to indices the index uses.
+                if (!quietMode) printf("QUERY - enter the pair of names for the predator and the prey.\n");
+                if (!quietMode) printf("The format is <predator name> <prey name>: ");
+                predInd = readWord(&tempName,&capTempName) ? findOrgByName(&web,tempName) : -1;
+                preyInd = readWord(&tempName,&capTempName) ? findOrgByName(&web,tempName) : -1;
+                if (!quietMode) printf("\n");
+
+                int eats = (predInd < 0 || preyInd < 0) ? -1 : queryReach(&web,predInd,preyInd);
+                if (predInd < 0 || preyInd < 0) {
+                    printf("Unknown predator and/or prey name.\n");
+                } else if (eats == 1) {
+                    printf("Energy Flow: %s ultimately eats %s\n", orgName(&web,predInd), orgName(&web,preyInd));
+                } else if (eats == 0) {
+                    printf("No Energy Flow: %s does not ultimately eat %s\n", orgName(&web,predInd), orgName(&web,preyInd));
+                }
+                printf("\n");
+
+            } else if (opt == 'w') { // What-if Branches
+                compactWeb(&web); // Branches share the web's indices and names.
+                if (!quietMode) printf("WHAT-IF - branch 0 is the current web. Enter f <branch> to fork a branch,\n");
+                if (!quietMode) printf("x <branch> <name> or r <branch> <predator name> <prey name> to change one,\n");
+                if (!quietMode) printf("p <branch> or d <branch> to print or analyze one, then end: ");
+                BranchSet branches;
+                if (!freezeWeb(&web,&branches)) {
+                    printf("Could not branch the food web.\n");
+                }
+                bool gotCmd = readWord(&tempName,&capTempName);
+                while (gotCmd && strcmp(tempName,"end") != 0) {
+                    char kind = (strlen(tempName) == 1) ? tempName[0] : '?';
+                    int branchInd = -1;
+                    if (kind != 'f' && kind != 'x' && kind != 'r' && kind != 'p' && kind != 'd') {
+                        printf("Invalid what-if command: %s\n", tempName);
+                    } else if (scanf("%d",&branchInd) != 1 || branchInd < 0 || branchInd >= branches.numBranches) {
+                        printf("Invalid branch for what-if command %c\n", kind);
+                        branchInd = -1;
+                    }
+
+                    if (kind == 'x') {
+                        int extInd = readWord(&tempName,&capTempName) ? findOrgByName(&web,tempName) : -1;
+                        if (branchInd < 0) {
+                            // Already reported.
+                        } else if (extInd >= 0 && removeBranchOrg(&branches,branchInd,extInd)) {
+                            printf("Branch %d Species Extinction: %s\n", branchInd, orgName(&web,extInd));
+                        } else {
+                            printf("Invalid name for species extinction in branch %d\n", branchInd);
+                        }
+                    } else if (kind == 'r') {
+                        predInd = readWord(&tempName,&capTempName) ? findOrgByName(&web,tempName) : -1;
+                        preyInd = readWord(&tempName,&capTempName) ? findOrgByName(&web,tempName) : -1;
+                        if (branchInd < 0) {
+                            // Already reported.
+                        } else if (predInd >= 0 && preyInd >= 0 && addBranchRelation(&branches,branchInd,predInd,preyInd)) {
+                            printf("Branch %d New Food Source: %s eats %s\n", branchInd, orgName(&web,predInd), orgName(&web,preyInd));
+                        } else {
+                            printf("Invalid or duplicate relation. No relation added to branch %d.\n", branchInd);
+                        }
+                    } else if (kind == 'f' && branchInd >= 0) {
+                        int newInd = forkBranch(&branches,branchInd);
+                        if (newInd >= 0) {
+                            printf("Branch %d: forked from branch %d\n", newInd, branchInd);
+                        }
+                    } else if ((kind == 'p' || kind == 'd') && branchInd >= 0) {
+                        Web branchWeb;
+                        initWeb(&branchWeb);
+                        if (!thawBranch(&branches,branchInd,&branchWeb)) {
+                            printf("Could not rebuild branch %d.\n", branchInd);
+                        } else if (kind == 'p') {
+                            printf("Branch %d Food Web Predators & Prey:\n", branchInd);
+                            printWeb(&branchWeb, stdout);
+                        } else {
+                            printf("Displaying characteristics for branch %d...\n\n", branchInd);
+                            displayAll(&branchWeb, true, stdout);
+                        }
+                        freeWeb(&branchWeb);
+                    }
+                    gotCmd = readWord(&tempName,&capTempName);
+                }
+                if (!quietMode) printf("\n");
+                printf("What-if Branches: %d sharing %ld trie nodes, %ld organism records and %ld relation blocks\n",
+                       branches.numBranches, branches.numNodes, branches.numRecords, branches.numBlocks);
+                printf("\n");
+                freeBranchSet(&branches);
+
+            } else if (opt == 'c') { // Count Food Chains
+                if (countFoodChains(&web)) {
+                    ChainCounts* chains = &(web.chains);
+                    printf("Food Chains (producer to apex predator): ");
+                    printChainCount(chains -> totalMod, chains -> totalEst);
                     printf("\n");
+                    printf("Food Chains Through Each Species:\n");
+                    for (int i = 0; i < web.numOrgs; i++) {
+                        int c = web.cond.compOf[i];
+                        bool none = (chains -> upEst[c] == 0.0L || chains -> downEst[c] == 0.0L);
+                        printf("  %s: ", orgName(&web,i));
+                        printChainCount(none ? 0 : mulChainMod(chains -> upMod[c], chains -> downMod[c]),
+                                        none ? 0.0L : chains -> upEst[c] * chains -> downEst[c]);
+                        printf("\n");
+                    }
+                } else {
+                    printf("Could not count the food chains.\n");
+                }
+                printf("\n");
+
+            } else if (opt == 'm') { // Population Dynamics
+                int numSteps;
+                double step;
+                if (!quietMode) printf("SIMULATION - enter the number of steps and the step size: ");
+                bool gotSteps = (scanf("%d %lf",&numSteps,&step) == 2);
+                if (!quietMode) printf("\n");
+
+                Dynamics dyn;
+                initDynamics(&dyn);
+                if (!gotSteps || numSteps < 0 || !(step > 0.0 && step <= 1.0)) {
+                    printf("Invalid number of steps or step size for the simulation\n");
+                } else if (!startDynamics(&web,&dyn)) {
+                    printf("Could not simulate the population dynamics.\n");
+                } else {
+                    simulateDynamics(&web,&dyn,numSteps,step);
+                    int numAlive = 0;
+                    for (int i = 0; i < web.numOrgs; i++) {
+                        numAlive += (dyn.biomass[i] > 0.0);
+                    }
+                    printf("Population Dynamics after %d steps of %g (%d of %d species persist):\n",
+                           numSteps, step, numAlive, web.numOrgs);
+                    for (int i = 0; i < web.numOrgs; i++) {
+                        if (dyn.biomass[i] > 0.0) {
+                            printf("  %s: %.4f\n", orgName(&web,i), dyn.biomass[i]);
+                        } else {
+                            printf("  %s: died out\n", orgName(&web,i));
+                        }
+                    }
                 }
+                freeDynamics(&dyn);
+                printf("\n");
 
             } else if (opt == 'p') { // Print Current Web
                 printf("UPDATED Food Web Predators & Prey:\n");
-                printWeb(web,numOrgs);
+                printWeb(&web, stdout);
                 printf("\n");
 
             } else if (opt == 'd') { // Full Analysis
                 printf("Displaying characteristics for the UPDATED food web...\n\n");
-                displayAll(web,numOrgs,true);
+                displayAll(&web, true, stdout);
 
             }
             printf("--------------------------------\n\n");
@@ -660,11 +5439,21 @@ int main(int argc, char* argv[]) {
 
     }
 
+    // Save a Snapshot of the Final Web if Requested.
+    if (saveFile != NULL) {
+        if (saveWeb(&web, saveFile)) {
+            printf("Saved a snapshot of the food web to %s.\n\n", saveFile);
+        } else {
+            printf("Could not save a snapshot of the food web to %s.\n\n", saveFile);
+        }
+    }
+
     // Cleanup
-    freeWeb(web,numOrgs); // Free All Allocated Memory.
+    freeWeb(&web); // Free All Allocated Memory.
+    free(tempName);
 
     //printf("\n\n");
 
     return 0;
 }
-
+#endif
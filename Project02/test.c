@@ -0,0 +1,648 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#define FOOD_WEB_NO_MAIN
+#include "main.c"
+
+#define TEST_SNAPSHOT "test.snap"
+
+// Live rank of every slot (its index after compaction), -1 for tombstones.
+void liveRanks(Web* web, int* ranks) {
+    int rank = 0;
+    for (int i = 0; i < web -> numOrgs; i++) {
+        ranks[i] = web -> orgs[i].extinct ? -1 : rank++;
+    }
+}
+
+// Check everything the web maintains incrementally against values recomputed
+// from its prey runs: predator runs and in-degrees, producer-prey counts, the
+// edge hash set, the name index, the degree buckets and, while they are
+// marked valid, the heights. Prints the first problem found.
+bool checkInvariants(Web* web) {
+    int numOrgs = web -> numOrgs;
+    int* numPred = (int*)calloc((size_t)numOrgs + 1, sizeof(int));
+    int* height = (int*)malloc(((size_t)numOrgs + 1) * sizeof(int));
+    bool ok = (numPred != NULL && height != NULL);
+
+    // Relations, seen from both ends.
+    int numLive = 0;
+    int64_t numEdges = 0;
+    int maxPrey = 0;
+    int maxPred = 0;
+    for (int i = 0; ok && i < numOrgs; i++) {
+        Org* org = &(web -> orgs[i]);
+        if (org -> extinct) {
+            continue;
+        }
+        numLive++;
+        numEdges += org -> numPrey;
+        if (org -> numPrey > maxPrey) {
+            maxPrey = org -> numPrey;
+        }
+        int numProducerPrey = 0;
+        for (int j = 0; ok && j < org -> numPrey; j++) {
+            int preyInd = preyOf(web, i)[j];
+            numPred[preyInd]++;
+            numProducerPrey += (web -> orgs[preyInd].numPrey == 0);
+            int found = 0;
+            for (int k = 0; k < web -> links[preyInd].numPred; k++) {
+                found += (predsOf(web, preyInd)[k] == i);
+            }
+            if (web -> orgs[preyInd].extinct || preyInd == i || found != 1 || !hasRelation(web, i, preyInd)) {
+                printf("  relation %d eats %d is not stored consistently\n", i, preyInd);
+                ok = false;
+            }
+        }
+        if (ok && numProducerPrey != web -> links[i].numProducerPrey) {
+            printf("  organism %d: expected %d producer prey, actual %d\n", i, numProducerPrey, web -> links[i].numProducerPrey);
+            ok = false;
+        }
+        if (ok && findOrgByName(web, orgName(web, i)) != i) {
+            printf("  organism %d: name %s is not indexed\n", i, orgName(web, i));
+            ok = false;
+        }
+    }
+    for (int i = 0; ok && i < numOrgs; i++) {
+        if (!web -> orgs[i].extinct && numPred[i] != web -> links[i].numPred) {
+            printf("  organism %d: expected %d predators, actual %d\n", i, numPred[i], web -> links[i].numPred);
+            ok = false;
+        }
+        if (!web -> orgs[i].extinct && numPred[i] > maxPred) {
+            maxPred = numPred[i];
+        }
+    }
+    if (ok && (numEdges != web -> numEdges || numLive != numOrgs - web -> numExtinct)) {
+        printf("  expected %d live organisms and %lld relations, actual %d and %lld\n", numLive, (long long)numEdges,
+               numOrgs - web -> numExtinct, (long long)web -> numEdges);
+        ok = false;
+    }
+
+    // Every live organism sits in the bucket for its degree, exactly once.
+    Buckets* bucketSets[] = {&(web -> byNumPred), &(web -> byNumPrey)};
+    int maxDegs[] = {maxPred, maxPrey};
+    for (int b = 0; ok && b < 2; b++) {
+        int numSeen = 0;
+        for (int d = 0; ok && d < bucketSets[b] -> capHeads; d++) {
+            int prev = -1;
+            for (int i = bucketSets[b] -> heads[d]; ok && i != -1; i = bucketSets[b] -> next[i]) {
+                int deg = (b == 0) ? web -> links[i].numPred : web -> orgs[i].numPrey;
+                if (web -> orgs[i].extinct || deg != d || bucketSets[b] -> prev[i] != prev || ++numSeen > numLive) {
+                    printf("  organism %d is misplaced in %s bucket %d\n", i, (b == 0) ? "predator" : "prey", d);
+                    ok = false;
+                }
+                prev = i;
+            }
+        }
+        if (ok && (numSeen != numLive || bucketSets[b] -> maxDeg != maxDegs[b])) {
+            printf("  %s buckets: expected %d organisms up to degree %d, actual %d up to %d\n",
+                   (b == 0) ? "predator" : "prey", numLive, maxDegs[b], numSeen, bucketSets[b] -> maxDeg);
+            ok = false;
+        }
+    }
+
+    // Heights by relaxation: one more than the highest prey, until none changes.
+    if (ok && web -> heightsValid) {
+        for (int i = 0; i < numOrgs; i++) {
+            height[i] = 0;
+        }
+        bool changed = true;
+        for (int pass = 0; changed && pass <= numOrgs; pass++) {
+            changed = false;
+            for (int i = 0; i < numOrgs; i++) {
+                for (int j = 0; !web -> orgs[i].extinct && j < web -> orgs[i].numPrey; j++) {
+                    if (height[preyOf(web, i)[j]] + 1 > height[i]) {
+                        height[i] = height[preyOf(web, i)[j]] + 1;
+                        changed = true;
+                    }
+                }
+            }
+        }
+        for (int i = 0; ok && i < numOrgs; i++) {
+            if (!web -> orgs[i].extinct && height[i] != web -> links[i].height) {
+                printf("  organism %d: expected height %d, actual %d\n", i, height[i], web -> links[i].height);
+                ok = false;
+            }
+        }
+    }
+
+    // Typed indices resolve to the live organism of that rank.
+    int rank = 0;
+    for (int i = 0; ok && i < numOrgs; i++) {
+        if (!web -> orgs[i].extinct && selectLiveOrg(web, rank++) != i) {
+            printf("  index %d does not select organism %d\n", rank - 1, i);
+            ok = false;
+        }
+    }
+    if (ok && (selectLiveOrg(web, rank) != -1 || selectLiveOrg(web, -1) != -1)) {
+        printf("  an index past the live organisms selected one\n");
+        ok = false;
+    }
+
+    free(numPred);
+    free(height);
+    return ok;
+}
+
+// Whether two webs hold the same live organisms in the same order, each with
+// the same prey (compared by live rank, in any order).
+bool sameWeb(Web* a, Web* b) {
+    if (a -> numOrgs - a -> numExtinct != b -> numOrgs - b -> numExtinct || a -> numEdges != b -> numEdges) {
+        return false;
+    }
+    int* ranksA = (int*)malloc(((size_t)a -> numOrgs + 1) * sizeof(int));
+    int* ranksB = (int*)malloc(((size_t)b -> numOrgs + 1) * sizeof(int));
+    int* preyA = (int*)malloc(((size_t)a -> numOrgs + 1) * sizeof(int));
+    int* preyB = (int*)malloc(((size_t)b -> numOrgs + 1) * sizeof(int));
+    bool same = (ranksA != NULL && ranksB != NULL && preyA != NULL && preyB != NULL);
+    if (same) {
+        liveRanks(a, ranksA);
+        liveRanks(b, ranksB);
+    }
+    int j = 0;
+    for (int i = 0; same && i < a -> numOrgs; i++) {
+        if (a -> orgs[i].extinct) {
+            continue;
+        }
+        while (b -> orgs[j].extinct) {
+            j++;
+        }
+        int numPrey = a -> orgs[i].numPrey;
+        same = (strcmp(orgName(a, i), orgName(b, j)) == 0) && (numPrey == b -> orgs[j].numPrey);
+        for (int k = 0; same && k < numPrey; k++) {
+            preyA[k] = ranksA[preyOf(a, i)[k]];
+            preyB[k] = ranksB[preyOf(b, j)[k]];
+        }
+        if (same) {
+            qsort(preyA, numPrey, sizeof(int), compareInts);
+            qsort(preyB, numPrey, sizeof(int), compareInts);
+            same = (memcmp(preyA, preyB, numPrey * sizeof(int)) == 0);
+        }
+        j++;
+    }
+    free(ranksA);
+    free(ranksB);
+    free(preyA);
+    free(preyB);
+    return same;
+}
+
+// Pick a random live organism, or -1 if there is none.
+int randomLiveOrg(Web* web, uint64_t* state) {
+    if (web -> numOrgs == web -> numExtinct) {
+        return -1;
+    }
+    int orgInd;
+    do {
+        orgInd = (int)(nextRandom(state) % (uint64_t)web -> numOrgs);
+    } while (web -> orgs[orgInd].extinct);
+    return orgInd;
+}
+
+// Add a random relation from a later organism to an earlier one, so that the
+// web never has a feeding cycle. Returns false if no new relation was found.
+bool addRandomRelation(Web* web, uint64_t* state) {
+    for (int attempt = 0; attempt < 20; attempt++) {
+        int a = randomLiveOrg(web, state);
+        int b = randomLiveOrg(web, state);
+        if (a != b && a != -1 && !hasRelation(web, (a > b) ? a : b, (a > b) ? b : a)) {
+            return addRelationToWeb(web, (a > b) ? a : b, (a > b) ? b : a);
+        }
+    }
+    return false;
+}
+
+// Build the same web every time for the same seed.
+bool buildRandomWeb(Web* web, int numOrgs, int numRelations, uint64_t seed) {
+    char name[16];
+    for (int i = 0; i < numOrgs; i++) {
+        sprintf(name, "s%d", i);
+        if (!addOrgToWeb(web, name)) {
+            return false;
+        }
+    }
+    for (int k = 0; k < numRelations; k++) {
+        addRandomRelation(web, &seed);
+    }
+    return true;
+}
+
+// Read a whole file into a new buffer.
+char* readTestFile(const char* path, size_t* pLen) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    *pLen = (size_t)ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* data = (char*)malloc(*pLen + 1);
+    if (data != NULL && fread(data, 1, *pLen, file) != *pLen) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    return data;
+}
+
+bool writeTestFile(const char* path, const char* data, size_t len) {
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        return false;
+    }
+    bool ok = (fwrite(data, 1, len, file) == len);
+    return (fclose(file) == 0) && ok;
+}
+
+bool test_incrementalWeb() {
+    Web web;
+    initWeb(&web);
+    uint64_t state = 2025;
+    char name[16];
+    int numOrgsAdded = 0;
+    bool ok = true;
+
+    printf(" Checking degrees, buckets and heights after each of 3000 random changes:\n");
+    for (int step = 0; ok && step < 3000; step++) {
+        int op = (int)(nextRandom(&state) % 10);
+        if (op < 2 || web.numOrgs - web.numExtinct < 2) {
+            sprintf(name, "s%d", numOrgsAdded++);
+            ok = addOrgToWeb(&web, name);
+        } else if (op < 8) {
+            addRandomRelation(&web, &state);
+        } else if (op < 9) {
+            ok = removeOrgFromWeb(&web, randomLiveOrg(&web, &state));
+        } else {
+            ok = compactWeb(&web) && (web.numExtinct == 0);
+        }
+        if (ok && !checkInvariants(&web)) {
+            printf("  after step %d (operation %d)\n", step, op);
+            ok = false;
+        }
+    }
+
+    printf(" Checking that printing and displaying leave the web as it was:\n");
+    if (ok) {
+        for (int k = 0; k < 5 && web.numOrgs - web.numExtinct > 1; k++) {
+            removeOrgFromWeb(&web, randomLiveOrg(&web, &state));
+        }
+        unsigned int version = web.version;
+        int numOrgs = web.numOrgs;
+        int numExtinct = web.numExtinct;
+        Org* orgs = web.orgs;
+        printWeb(&web, NULL);
+        displayAll(&web, false, NULL);
+        if (web.version != version || web.numOrgs != numOrgs || web.numExtinct != numExtinct || web.orgs != orgs ||
+            !checkInvariants(&web)) {
+            printf("  expected %d slots with %d extinct, actual %d with %d\n", numOrgs, numExtinct,
+                   web.numOrgs, web.numExtinct);
+            ok = false;
+        }
+    }
+
+    printf(" Checking that a recompute agrees with the maintained heights:\n");
+    if (ok) {
+        int* heights = (int*)malloc(((size_t)web.numOrgs + 1) * sizeof(int));
+        for (int i = 0; i < web.numOrgs; i++) {
+            heights[i] = web.links[i].height;
+        }
+        ok = web.heightsValid && recomputeHeights(&web) && web.heightsValid;
+        for (int i = 0; ok && i < web.numOrgs; i++) {
+            if (!web.orgs[i].extinct && heights[i] != web.links[i].height) {
+                printf("  organism %d: maintained height %d, recomputed %d\n", i, heights[i], web.links[i].height);
+                ok = false;
+            }
+        }
+        free(heights);
+    }
+
+    printf(" Checking that a feeding cycle marks the heights stale:\n");
+    if (ok) {
+        addOrgToWeb(&web, "cycleA");
+        addOrgToWeb(&web, "cycleB");
+        addRelationToWeb(&web, web.numOrgs - 2, web.numOrgs - 1);
+        addRelationToWeb(&web, web.numOrgs - 1, web.numOrgs - 2);
+        if (!recomputeHeights(&web) || web.heightsValid || !checkInvariants(&web)) {
+            printf("  expected heights marked stale, actual valid = %d\n", web.heightsValid);
+            ok = false;
+        }
+    }
+
+    freeWeb(&web);
+    return ok;
+}
+
+bool test_saveWeb_loadWeb() {
+    Web web;
+    Web loaded;
+    initWeb(&web);
+    initWeb(&loaded);
+    uint64_t state = 7;
+    bool ok = buildRandomWeb(&web, 80, 400, 11);
+    for (int k = 0; ok && k < 10; k++) {
+        ok = removeOrgFromWeb(&web, randomLiveOrg(&web, &state));
+    }
+
+    printf(" Checking a snapshot of a web with extinctions:\n");
+    if (ok && (!saveWeb(&web, TEST_SNAPSHOT) || !loadWeb(&loaded, TEST_SNAPSHOT))) {
+        printf("  could not save and load %s\n", TEST_SNAPSHOT);
+        ok = false;
+    }
+    if (ok && (!sameWeb(&web, &loaded) || !checkInvariants(&loaded))) {
+        printf("  the loaded web differs from the saved one\n");
+        ok = false;
+    }
+
+    printf(" Checking that a loaded web rejects a duplicate relation:\n");
+    int predInd = -1;
+    for (int i = 0; ok && predInd == -1 && i < loaded.numOrgs; i++) {
+        predInd = (loaded.orgs[i].numPrey > 0) ? i : -1;
+    }
+    if (ok && (predInd == -1 || addRelationToWeb(&loaded, predInd, preyOf(&loaded, predInd)[0]) ||
+               loaded.numEdges != web.numEdges)) {
+        printf("  expected the duplicate rejected and %lld relations, actual %lld\n",
+               (long long)web.numEdges, (long long)loaded.numEdges);
+        ok = false;
+    }
+
+    printf(" Checking changes to a loaded web:\n");
+    for (int k = 0; ok && k < 50; k++) {
+        addRandomRelation(&loaded, &state);
+        if (k % 10 == 0) {
+            ok = removeOrgFromWeb(&loaded, randomLiveOrg(&loaded, &state));
+        }
+    }
+    if (ok && (loaded.snapshot != NULL || !checkInvariants(&loaded))) {
+        printf("  the loaded web was not updated consistently\n");
+        ok = false;
+    }
+
+    freeWeb(&web);
+    freeWeb(&loaded);
+    remove(TEST_SNAPSHOT);
+    return ok;
+}
+
+// Save a small web, let edit() change the saved bytes, and check that
+// loading the result fails without touching the web it was loaded into.
+bool rejectsEditedSnapshot(const char* what, void (*edit)(char* data, size_t* pLen)) {
+    Web web;
+    Web target;
+    initWeb(&web);
+    initWeb(&target);
+    bool ok = buildRandomWeb(&web, 20, 40, 3) && saveWeb(&web, TEST_SNAPSHOT) && addOrgToWeb(&target, "Kept");
+    size_t len = 0;
+    char* data = ok ? readTestFile(TEST_SNAPSHOT, &len) : NULL;
+    ok = ok && (data != NULL);
+    if (ok) {
+        edit(data, &len);
+        ok = writeTestFile(TEST_SNAPSHOT, data, len);
+    }
+    if (ok && loadWeb(&target, TEST_SNAPSHOT)) {
+        printf("  a snapshot with %s was loaded\n", what);
+        ok = false;
+    }
+    if (ok && (target.numOrgs != 1 || strcmp(orgName(&target, 0), "Kept") != 0)) {
+        printf("  a rejected snapshot with %s changed the web\n", what);
+        ok = false;
+    }
+    free(data);
+    freeWeb(&web);
+    freeWeb(&target);
+    remove(TEST_SNAPSHOT);
+    return ok;
+}
+
+void truncateSnapshot(char* data, size_t* pLen) {
+    (void)data;
+    *pLen /= 2;
+}
+
+void editEdge(char* data, size_t* pLen) {
+    (void)pLen;
+    SnapshotHeader* header = (SnapshotHeader*)data;
+    int* edges = (int*)(data + header -> offsets[2]);
+    edges[0] = header -> numOrgs;
+}
+
+void editPreyRun(char* data, size_t* pLen) {
+    (void)pLen;
+    SnapshotHeader* header = (SnapshotHeader*)data;
+    Org* orgs = (Org*)(data + header -> offsets[0]);
+    orgs[header -> numOrgs - 1].preyStart = 2 * header -> numEdges;
+    orgs[header -> numOrgs - 1].preyCap = 1;
+}
+
+void editNameOffset(char* data, size_t* pLen) {
+    (void)pLen;
+    SnapshotHeader* header = (SnapshotHeader*)data;
+    Org* orgs = (Org*)(data + header -> offsets[0]);
+    orgs[0].nameOff = header -> lenNames;
+}
+
+void editBucketLink(char* data, size_t* pLen) {
+    (void)pLen;
+    SnapshotHeader* header = (SnapshotHeader*)data;
+    int* next = (int*)(data + header -> offsets[7]);
+    next[0] = header -> numOrgs + 5;
+}
+
+void fillNameIndex(char* data, size_t* pLen) {
+    (void)pLen;
+    SnapshotHeader* header = (SnapshotHeader*)data;
+    NameEntry* nameIndex = (NameEntry*)(data + header -> offsets[4]);
+    for (int i = 0; i < header -> capNameIndex; i++) {
+        if (nameIndex[i].nameOff == -1) {
+            nameIndex[i].nameOff = 0;
+            nameIndex[i].hash = 1;
+        }
+    }
+}
+
+void loopBucket(char* data, size_t* pLen) {
+    (void)pLen;
+    SnapshotHeader* header = (SnapshotHeader*)data;
+    int* heads = (int*)(data + header -> offsets[5]);
+    int* next = (int*)(data + header -> offsets[7]);
+    next[heads[0]] = heads[0];
+}
+
+void moveToWrongBucket(char* data, size_t* pLen) {
+    (void)pLen;
+    SnapshotHeader* header = (SnapshotHeader*)data;
+    int* heads = (int*)(data + header -> offsets[8]);
+    heads[header -> capPreyHeads - 1] = heads[0];
+    heads[0] = -1;
+}
+
+bool test_loadWeb_rejects() {
+    printf(" Checking a truncated snapshot:\n");
+    if (!rejectsEditedSnapshot("half its bytes", truncateSnapshot)) {
+        return false;
+    }
+    printf(" Checking a snapshot with an edge to no organism:\n");
+    if (!rejectsEditedSnapshot("an edge out of range", editEdge)) {
+        return false;
+    }
+    printf(" Checking a snapshot with a prey run past the edge arena:\n");
+    if (!rejectsEditedSnapshot("a prey run out of range", editPreyRun)) {
+        return false;
+    }
+    printf(" Checking a snapshot with a name past the name pool:\n");
+    if (!rejectsEditedSnapshot("a name out of range", editNameOffset)) {
+        return false;
+    }
+    printf(" Checking a snapshot with a bucket link to no organism:\n");
+    if (!rejectsEditedSnapshot("a bucket link out of range", editBucketLink)) {
+        return false;
+    }
+    printf(" Checking a snapshot whose name index has no empty slot:\n");
+    if (!rejectsEditedSnapshot("a full name index", fillNameIndex)) {
+        return false;
+    }
+    printf(" Checking a snapshot with a cycle in a bucket list:\n");
+    if (!rejectsEditedSnapshot("a bucket cycle", loopBucket)) {
+        return false;
+    }
+    printf(" Checking a snapshot with organisms in the wrong bucket:\n");
+    if (!rejectsEditedSnapshot("a misplaced bucket", moveToWrongBucket)) {
+        return false;
+    }
+    return true;
+}
+
+bool test_branches() {
+    Web web;
+    Web expected;
+    Web thawed;
+    BranchSet set;
+    initWeb(&web);
+    initWeb(&expected);
+    initWeb(&thawed);
+    bool ok = buildRandomWeb(&web, 100, 300, 5) && buildRandomWeb(&expected, 100, 300, 5) && freezeWeb(&web, &set);
+    if (!ok) {
+        printf("  could not build and freeze the web\n");
+        freeWeb(&web);
+        freeWeb(&expected);
+        return false;
+    }
+
+    // Branch 1 loses two organisms and gains relations; branch 2 forks from
+    // it and loses one more. The web makes the same changes as branch 1.
+    int branch1 = forkBranch(&set, 0);
+    ok = (branch1 == 1);
+    int removed[] = {3, 50};
+    for (int k = 0; ok && k < 2; k++) {
+        ok = removeBranchOrg(&set, branch1, removed[k]) && removeOrgFromWeb(&expected, removed[k]);
+    }
+    uint64_t state = 9;
+    for (int k = 0; ok && k < 30; k++) {
+        int a = randomLiveOrg(&expected, &state);
+        int b = randomLiveOrg(&expected, &state);
+        if (a > b && !hasRelation(&expected, a, b)) {
+            ok = addBranchRelation(&set, branch1, a, b) && addRelationToWeb(&expected, a, b);
+        }
+    }
+    int branch2 = ok ? forkBranch(&set, branch1) : -1;
+    ok = ok && (branch2 == 2) && removeBranchOrg(&set, branch2, 99);
+
+    printf(" Checking that the original branch is unchanged:\n");
+    if (ok && (!thawBranch(&set, 0, &thawed) || !sameWeb(&web, &thawed) || !checkInvariants(&thawed))) {
+        printf("  branch 0 differs from the frozen web\n");
+        ok = false;
+    }
+    freeWeb(&thawed);
+
+    printf(" Checking that a branch holds exactly its own changes:\n");
+    if (ok && (!thawBranch(&set, branch1, &thawed) || !sameWeb(&expected, &thawed) || !checkInvariants(&thawed))) {
+        printf("  branch 1 differs from the web given the same changes\n");
+        ok = false;
+    }
+    freeWeb(&thawed);
+
+    printf(" Checking that a fork does not change the branch it came from:\n");
+    if (ok && (!thawBranch(&set, branch2, &thawed) || thawed.numOrgs != expected.numOrgs - expected.numExtinct - 1)) {
+        printf("  branch 2 does not have one organism fewer than branch 1\n");
+        ok = false;
+    }
+    freeWeb(&thawed);
+    if (ok && (!thawBranch(&set, branch1, &thawed) || !sameWeb(&expected, &thawed))) {
+        printf("  branch 1 changed when branch 2 did\n");
+        ok = false;
+    }
+
+    freeWeb(&thawed);
+    freeBranchSet(&set);
+    freeWeb(&web);
+    freeWeb(&expected);
+    return ok;
+}
+
+bool test_countFoodChains() {
+    Web web;
+    initWeb(&web);
+    const char* names[] = {"Grass", "Rabbit", "Mouse", "Fox", "Moss"};
+    for (int i = 0; i < 5; i++) {
+        addOrgToWeb(&web, (char*)names[i]);
+    }
+    addRelationToWeb(&web, 1, 0);
+    addRelationToWeb(&web, 2, 0);
+    addRelationToWeb(&web, 3, 1);
+    addRelationToWeb(&web, 3, 2);
+
+    printf(" Checking Grass -> Rabbit/Mouse -> Fox with an isolated Moss:\n");
+    bool ok = countFoodChains(&web);
+    if (ok && web.chains.totalMod != 2) {
+        printf("  expected 2 food chains, actual %llu\n", (unsigned long long)web.chains.totalMod);
+        ok = false;
+    }
+    int moss = web.cond.compOf[4];
+    if (ok && (web.chains.upMod[moss] != 0 || web.chains.downMod[moss] != 0)) {
+        printf("  expected no food chains through Moss\n");
+        ok = false;
+    }
+    freeWeb(&web);
+    return ok;
+}
+
+int main() {
+    printf("Welcome to the Food Web Testing Suite!\n\n");
+
+    printf("Testing incremental web maintenance...\n");
+    if (test_incrementalWeb()) {
+        printf("  All tests PASSED!\n");
+    } else {
+        printf("  test FAILED.\n");
+    }
+
+    printf("Testing saveWeb() and loadWeb()...\n");
+    if (test_saveWeb_loadWeb()) {
+        printf("  All tests PASSED!\n");
+    } else {
+        printf("  test FAILED.\n");
+    }
+
+    printf("Testing loadWeb() on corrupted snapshots...\n");
+    if (test_loadWeb_rejects()) {
+        printf("  All tests PASSED!\n");
+    } else {
+        printf("  test FAILED.\n");
+    }
+
+    printf("Testing what-if branches...\n");
+    if (test_branches()) {
+        printf("  All tests PASSED!\n");
+    } else {
+        printf("  test FAILED.\n");
+    }
+
+    printf("Testing countFoodChains()...\n");
+    if (test_countFoodChains()) {
+        printf("  All tests PASSED!\n");
+    } else {
+        printf("  test FAILED.\n");
+    }
+
+    return 0;
+}
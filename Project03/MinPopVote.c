@@ -184,36 +184,40 @@ MinInfo minPopVoteToWin(State* states, int szStates) {
     return minPopVoteAtLeast(states, szStates, 0, reqEVs);
 }
 
-// Memoized version of minimum votes calculator.
-MinInfo minPopVoteAtLeastFast(State* states, int szStates, int start, int EVs, MinInfo** memo) {
+// Memoized version of minimum votes calculator. Returns only the popular
+// votes of the best subset (CANNOT_WIN if there is none). Each memo cell
+// keeps that number, and one bit per cell in includes records whether the
+// best subset takes states[start]; minPopVoteToWinFast() rebuilds the subset
+// from those bits, so a cell costs 4 bytes and a bit instead of a MinInfo.
+int minPopVoteAtLeastFast(State* states, int szStates, int start, int EVs, int** memo, unsigned char** includes) {
     // Base case: Same as brute-force version.
-    if (start == szStates | EVs <= 0) {
-        MinInfo res;
-        res.subsetPVs = 0;
+    if (start == szStates || EVs <= 0) {
         if (EVs <= 0) {
-            res.sufficientEVs = true;
+            return 0;
         } else {
-            res.sufficientEVs = false;
+            return CANNOT_WIN;
         }
-        res.szSomeStates = 0;
-        return res;
     }
 
     // Returned memoized result if available.
-    if (memo[start][EVs].subsetPVs != -1) {
+    if (memo[start][EVs] != NOT_COMPUTED) {
         return memo[start][EVs];
     }
 
     // Recursive cases same as brute-force.
-    MinInfo exclude = minPopVoteAtLeastFast(states, szStates, start + 1, EVs, memo);
-    MinInfo include = minPopVoteAtLeastFast(states, szStates, start + 1, EVs - states[start].electoralVotes, memo);
-    include.subsetPVs += (states[start].popularVotes/2) + 1;
-    include.someStates[include.szSomeStates] = states[start];
-    include.szSomeStates++;
+    int exclude = minPopVoteAtLeastFast(states, szStates, start + 1, EVs, memo, includes);
+    int include = minPopVoteAtLeastFast(states, szStates, start + 1, EVs - states[start].electoralVotes, memo, includes);
+    if (include != CANNOT_WIN) {
+        include += (states[start].popularVotes/2) + 1;
+    }
 
-    // Store result in memo table before returning.
-    if (include.sufficientEVs && (!exclude.sufficientEVs || include.subsetPVs < exclude.subsetPVs)) {
+    // Store result and decision in memo table before returning. On a tie the
+    // state is left out (strict <), as this version always did; the
+    // brute-force version takes it (<=), so the two may pick different,
+    // equally cheap subsets.
+    if (include != CANNOT_WIN && (exclude == CANNOT_WIN || include < exclude)) {
         memo[start][EVs] = include;
+        includes[start][EVs / 8] |= (unsigned char)(1 << (EVs % 8));
     } else {
         memo[start][EVs] = exclude;
     }
@@ -227,23 +231,48 @@ MinInfo minPopVoteToWinFast(State* states, int szStates) {
     int totEVs = totalEVs(states, szStates);
     int reqEVs = totEVs/2 + 1;
 
-    // Initialize memoization table.
-    MinInfo** memo = (MinInfo**)malloc((szStates + 1)*sizeof(MinInfo*));
+    // Initialize memoization table: popular votes, and decision bits cleared.
+    int** memo = (int**)malloc((szStates + 1)*sizeof(int*));
+    unsigned char** includes = (unsigned char**)malloc((szStates + 1)*sizeof(unsigned char*));
     for (int i = 0; i < szStates + 1; ++i) {
-        memo[i] = (MinInfo*)malloc((reqEVs + 1)*sizeof(MinInfo));
+        memo[i] = (int*)malloc((reqEVs + 1)*sizeof(int));
         for (int j = 0; j < reqEVs + 1; ++j) {
-            memo[i][j].subsetPVs = -1;
+            memo[i][j] = NOT_COMPUTED;
         }
+        includes[i] = (unsigned char*)calloc(reqEVs/8 + 1, sizeof(unsigned char));
     }
 
-    MinInfo res = minPopVoteAtLeastFast(states, szStates, 0, reqEVs, memo);
+    int PVs = minPopVoteAtLeastFast(states, szStates, 0, reqEVs, memo, includes);
+
+    MinInfo res;
+    res.sufficientEVs = (PVs != CANNOT_WIN);
+    res.subsetPVs = res.sufficientEVs ? PVs : 0;
+    res.szSomeStates = 0;
+
+    // Rebuild the winning subset by following the decisions from the top.
+    // States were always listed from the last one back, so reverse them
+    // afterwards to keep that order.
+    int EVs = reqEVs;
+    for (int start = 0; res.sufficientEVs && start < szStates && EVs > 0; start++) {
+        if (includes[start][EVs / 8] & (1 << (EVs % 8))) {
+            res.someStates[res.szSomeStates++] = states[start];
+            EVs -= states[start].electoralVotes;
+        }
+    }
+    for (int i = 0, j = res.szSomeStates - 1; i < j; i++, j--) {
+        State temp = res.someStates[i];
+        res.someStates[i] = res.someStates[j];
+        res.someStates[j] = temp;
+    }
 
     // Clean up memoization memory.
     for (int i = 0; i < szStates + 1; i++) {
         free(memo[i]);
+        free(includes[i]);
     }
 
     free(memo);
+    free(includes);
     return res;
 }
 
@@ -4,6 +4,9 @@
 #ifndef MINPOPVOTE_H_
 #define MINPOPVOTE_H_
 
+#define NOT_COMPUTED -1 // memo cell of minPopVoteAtLeastFast() not filled in yet
+#define CANNOT_WIN -2   // no subset of the remaining states has enough electoral votes
+
 /* put any structure declarations here */
 typedef struct State_struct {
     char name[50];      // the name of the state, e.g. Illinois
@@ -30,7 +33,7 @@ int totalEVs(State* states, int szStates);
 int totalPVs(State* states, int szStates);
 MinInfo minPopVoteAtLeast(State* states, int szStates,  int start, int EVs);
 MinInfo minPopVoteToWin(State* states, int szStates);
-MinInfo minPopVoteAtLeastFast(State* states, int szStates, int start, int EVs, MinInfo** memo);
+int minPopVoteAtLeastFast(State* states, int szStates, int start, int EVs, int** memo, unsigned char** includes);
 MinInfo minPopVoteToWinFast(State* states, int szStates);
 
 #endif
\ No newline at end of file
@@ -526,6 +526,10 @@ bool test_minPVsFast() {
 
     MinInfo res = minPopVoteToWinFast(states, 4);
     bool expected = (res.subsetPVs == 47);
+    // The subset is rebuilt from the memo, in the same order as the slow version.
+    expected = expected && res.sufficientEVs && (res.szSomeStates == 2);
+    expected = expected && (strcmp(res.someStates[0].name, "C") == 0);
+    expected = expected && (strcmp(res.someStates[1].name, "B") == 0);
     return expected;
 }
 